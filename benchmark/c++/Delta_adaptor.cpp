@@ -0,0 +1,96 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+// Time per element of Delta(x, y) for the generic gf evaluator (the previous adaptor), the interpolation table of
+// Delta_block_adaptor element by element, and its batched fill_row and fill_col, for blocks of size 1, 2 and 4.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <triqs_ctseg/dets.hpp>
+
+using namespace triqs_ctseg;
+using op_t = std::pair<tau_t, int>;
+
+// Previous implementation of the adaptor, through the generic gf evaluator
+struct Delta_gf_adaptor {
+  gf<imtime, matrix_real_valued> Delta;
+
+  double operator()(op_t const &x, op_t const &y) const {
+    double res = Delta(double(x.first - y.first))(x.second, y.second);
+    return (x.first >= y.first ? res : -res);
+  }
+};
+
+// Time per element, in ns, of fill(x, ys, res) for each x, with rows of ys.size() elements, and the sum of the values
+auto time_per_element(auto const &fill, std::vector<op_t> const &xs, std::vector<op_t> const &ys) {
+  std::vector<double> res(ys.size());
+  double sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto const &x : xs) {
+    fill(x, res.data());
+    for (double r : res) sum += r;
+  }
+  std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+  return std::pair{1.e9 * d.count() / double(xs.size() * ys.size()), sum};
+}
+
+int main() {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  std::mt19937_64 rng(1);
+  long n_rows = 10000, row_size = 100; // Rows of the size of a typical det
+
+  for (int block_size : {1, 2, 4}) {
+    auto Delta = gf<imtime, matrix_real_valued>{{beta, Fermion, 10001}, {block_size, block_size}};
+    for (auto t : Delta.mesh()) {
+      double tau = t.value();
+      for (int a = 0; a < block_size; ++a)
+        for (int b = 0; b < block_size; ++b)
+          Delta[t](a, b) = (a == b) ? -0.5 * (std::exp(-(1 + 0.1 * a) * tau) + std::exp(-(beta - tau))) :
+                                      0.1 * std::sin(M_PI * tau / beta);
+    }
+    auto ref   = Delta_gf_adaptor{Delta};
+    auto table = Delta_block_adaptor{Delta};
+
+    std::vector<op_t> xs, ys;
+    for (long n = 0; n < n_rows; ++n) xs.emplace_back(tau_t{rng()}, int(rng() % block_size));
+    for (long n = 0; n < row_size; ++n) ys.emplace_back(tau_t{rng()}, int(rng() % block_size));
+    auto y = [&ys](long n) { return ys[n]; };
+
+    auto [t_gf, s_gf] = time_per_element(
+       [&](op_t const &x, double *res) {
+         for (long n = 0; n < row_size; ++n) res[n] = ref(x, ys[n]);
+       },
+       xs, ys);
+    auto [t_table, s_table] = time_per_element(
+       [&](op_t const &x, double *res) {
+         for (long n = 0; n < row_size; ++n) res[n] = table(x, ys[n]);
+       },
+       xs, ys);
+    auto [t_row, s_row] = time_per_element(
+       [&](op_t const &x, double *res) { table.fill_row(x, row_size, y, res); }, xs, ys);
+    // A column for each x, taken as the y of the column (the ys as the x of the rows)
+    auto [t_col, s_col] = time_per_element(
+       [&](op_t const &x, double *res) { table.fill_col(row_size, y, x, res); }, xs, ys);
+
+    std::cout << "block size " << block_size << ", time per element (ns): gf evaluator " << t_gf << ", table "
+              << t_table << ", fill_row " << t_row << ", fill_col " << t_col << ", speedup of fill_row "
+              << t_gf / t_row << " (sums " << s_gf << ", " << s_table << ", " << s_row << ", " << s_col << ")"
+              << std::endl;
+  }
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+// Time per element of Delta(tau) for the tau grid table, the pole representation with one std::exp per pole
+// (the evaluation before the pruning and the squaring), and the pole representation of Delta_block_adaptor.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <triqs_ctseg/dets.hpp>
+
+using namespace triqs_ctseg;
+
+// Delta_0(tau) with one std::exp per pole, including the ones discarded by the fit (c[p] = 0)
+double Delta_direct(Delta_poles_t const &poles, std::vector<double> const &c, double t) {
+  double res = 0;
+  for (long p = 0; p < poles.n_poles(); ++p) res += c[p] * std::exp(-poles.energies[p] * (t - poles.shifts[p]));
+  return res;
+}
+
+// Time per call of f(x, y), in ns, and the sum of the values
+auto time_per_call(auto const &f, std::vector<std::pair<tau_t, int>> const &xs,
+                   std::vector<std::pair<tau_t, int>> const &ys) {
+  double sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long n = 0; n < long(xs.size()); ++n) sum += f(xs[n], ys[n]);
+  std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+  return std::pair{1.e9 * d.count() / double(xs.size()), sum};
+}
+
+int main() {
+  double beta = 20;
+  tau_t::set_beta(beta);
+
+  // Discrete bath
+  auto eps   = std::vector<double>{-1.3, -0.2, 0.47, 2.2};
+  auto V     = std::vector<double>{0.5, 0.4, 0.8, 0.3};
+  auto Delta = gf<imtime, matrix_real_valued>{{beta, Fermion, 10001}, {1, 1}};
+  for (auto t : Delta.mesh()) {
+    double tau = t.value();
+    for (auto i : range(eps.size())) {
+      double e = eps[i];
+      Delta[t](0, 0) -= V[i] * V[i]
+         * (e > 0 ? std::exp(-e * tau) / (1 + std::exp(-beta * e)) : std::exp(e * (beta - tau)) / (1 + std::exp(beta * e)));
+    }
+  }
+
+  auto poles = fit_Delta_poles(Delta, 61, 20.0);
+  std::cout << "Poles: " << poles.n_poles() << ", kept: " << poles.kept.size() << ", chains: " << poles.n_chains
+            << ", max error: " << poles.max_error << "\n";
+
+  auto table   = Delta_block_adaptor{Delta};
+  auto adaptor = Delta_block_adaptor{poles, 1};
+  auto c_all   = std::vector<double>(poles.n_poles(), 0.0);
+  for (long j = 0; j < long(poles.kept.size()); ++j) c_all[poles.kept[j]] = poles.coefficients[j];
+  auto direct = [&poles, &c_all](std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y) {
+    double res = Delta_direct(poles, c_all, double(x.first - y.first));
+    return (x.first >= y.first ? res : -res);
+  };
+
+  long N = 1000000;
+  std::mt19937_64 rng(1);
+  std::vector<std::pair<tau_t, int>> xs, ys;
+  for (long n = 0; n < N; ++n) {
+    xs.emplace_back(tau_t{uint64_t{rng()}}, 0);
+    ys.emplace_back(tau_t{uint64_t{rng()}}, 0);
+  }
+
+  auto [t_table, s_table]   = time_per_call(table, xs, ys);
+  auto [t_direct, s_direct] = time_per_call(direct, xs, ys);
+  auto [t_poles, s_poles]   = time_per_call(adaptor, xs, ys);
+  std::cout << "Table:                   " << t_table << " ns/element (sum " << s_table << ")\n";
+  std::cout << "Poles, one exp per pole: " << t_direct << " ns/element (sum " << s_direct << ")\n";
+  std::cout << "Poles, adaptor:          " << t_poles << " ns/element (sum " << s_poles << ")\n";
+  std::cout << "Speedup of the adaptor over one exp per pole: " << t_direct / t_poles << "\n";
+}
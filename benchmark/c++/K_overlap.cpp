@@ -0,0 +1,99 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+// Time per overlap of a segment with the K lines of all the colors (as in the trace ratio of a move), for the
+// interpolation table of K_overlap and the generic gf evaluator it replaces, for 2, 6 and 10 colors.
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <triqs_ctseg/configuration.hpp>
+
+using namespace triqs_ctseg;
+
+// Previous implementation of K_overlap, through the generic gf evaluator
+double K_overlap_gf(seglist_t const &seglist, tau_t const &tau_c, tau_t const &tau_cdag,
+                    gf<imtime, matrix_valued> const &K, int c1, int c2) {
+  auto Ks       = slice_target_to_scalar(K, c1, c2);
+  double result = 0;
+  for (auto const &s : seglist) {
+    result += real(Ks(double(tau_c - s.tau_c)) + Ks(double(tau_cdag - s.tau_cdag)) - Ks(double(tau_cdag - s.tau_c))
+                   - Ks(double(tau_c - s.tau_cdag)));
+  }
+  return result;
+}
+
+// A random list of n non-overlapping segments, in decreasing order
+seglist_t random_seglist(std::mt19937_64 &rng, int n) {
+  std::vector<uint64_t> times(2 * n);
+  for (auto &t : times) t = rng();
+  std::sort(times.begin(), times.end(), std::greater<>{});
+  seglist_t sl;
+  for (int i = 0; i < n; ++i) sl.push_back(segment_t{tau_t{times[2 * i]}, tau_t{times[2 * i + 1]}});
+  return sl;
+}
+
+// Time per call of f(seg), in ns, over the segments, and the sum of the values
+auto time_per_call(auto const &f, std::vector<segment_t> const &segs) {
+  double sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto const &seg : segs) sum += f(seg);
+  std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+  return std::pair{1.e9 * d.count() / double(segs.size()), sum};
+}
+
+int main() {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  std::mt19937_64 rng(1);
+  int n_segments = 20; // Per color
+
+  for (int n_color : {2, 6, 10}) {
+    // Some smooth K_ab(tau), with K(0) = K(beta) = 0
+    auto K = gf<imtime>({beta, Boson, 10001}, {n_color, n_color});
+    for (auto t : K.mesh())
+      for (int a = 0; a < n_color; ++a)
+        for (int b = 0; b < n_color; ++b)
+          K[t](a, b) = (1 + 0.1 * (a + b)) * std::sinh(0.3 * t.value()) * std::sinh(0.3 * (beta - t.value()));
+    auto K_table = interp_table_t{K};
+
+    std::vector<seglist_t> seglists;
+    for (int c = 0; c < n_color; ++c) seglists.push_back(random_seglist(rng, n_segments));
+    std::vector<segment_t> segs;
+    for (long n = 0; n < 20000; ++n) segs.push_back(random_seglist(rng, 1)[0]);
+
+    auto table = [&](segment_t const &seg) {
+      double res = 0;
+      for (int c = 0; c < n_color; ++c) res += K_overlap(seglists[c], seg.tau_c, seg.tau_cdag, K_table, 0, c);
+      return res;
+    };
+    auto generic = [&](segment_t const &seg) {
+      double res = 0;
+      for (int c = 0; c < n_color; ++c) res += K_overlap_gf(seglists[c], seg.tau_c, seg.tau_cdag, K, 0, c);
+      return res;
+    };
+
+    auto [t_table, s_table] = time_per_call(table, segs);
+    auto [t_gf, s_gf]       = time_per_call(generic, segs);
+    std::cout << "n_color = " << n_color << ", " << n_segments
+              << " segments per color, time per call (ns): gf evaluator " << t_gf << ", interpolation table "
+              << t_table << ", speedup " << t_gf / t_table << " (sums " << s_gf << ", " << s_table << ")"
+              << std::endl;
+  }
+}
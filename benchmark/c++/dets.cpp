@@ -0,0 +1,85 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+// Time per try of insertion or removal (half of them accepted) around a given order of the det, for det_manip,
+// the delayed det and the small det, with a read of the whole inverse matrix every n_measure tries (as a measure).
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <triqs_ctseg/dets.hpp>
+#include <triqs_ctseg/util.hpp>
+
+using namespace triqs_ctseg;
+using op_t = std::pair<tau_t, int>;
+
+double time_per_try(det_t &D, long order, long n_tries, long n_measure) {
+  std::mt19937_64 rng(1);
+  auto insert = [&]() {
+    op_t x{tau_t{rng()}, 0}, y{tau_t{rng()}, 0};
+    return D.try_insert(det_lower_bound_x(D, x.first), det_lower_bound_y(D, y.first), x, y);
+  };
+  while (D.size() < order) {
+    insert();
+    D.complete_operation();
+  }
+  double sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long n = 0; n < n_tries; ++n) {
+    // Random walk around order
+    if (D.size() <= order)
+      sum += insert();
+    else
+      sum += D.try_remove(long(rng() % D.size()), long(rng() % D.size()));
+    if (rng() % 2 == 0)
+      D.complete_operation();
+    else
+      D.reject_last_try();
+    if (n % n_measure == 0) {
+      auto M_inv = D.inverse_matrix();
+      for (long j = 0; j < D.size(); ++j)
+        for (long i = 0; i < D.size(); ++i) sum += M_inv(j, i);
+    }
+  }
+  std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+  if (not std::isfinite(sum)) std::cout << "Non finite sum\n";
+  return 1.e9 * d.count() / double(n_tries);
+}
+
+int main() {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  auto Delta = gf<imtime, matrix_real_valued>{{beta, Fermion, 10001}, {1, 1}};
+  for (auto t : Delta.mesh())
+    Delta[t](0, 0) = -0.5 * (std::exp(-t.value()) + std::exp(-(beta - t.value()))) / (1 + std::exp(-beta));
+
+  long n_measure = 100;
+  std::cout << "Time per try (ns), with a read of the inverse every " << n_measure << " tries\n";
+  for (long order : {4, 8, 16, 50, 100, 200, 400}) {
+    long n_tries = std::max(2000l, 20000000 / (order * order + 100));
+    auto D_manip = det_t{Delta_block_adaptor{Delta}, 100};
+    double t_ref = time_per_try(D_manip, order, n_tries, n_measure);
+    std::cout << "order " << order << ": det_manip " << t_ref;
+    for (long n_delayed : {8, 32}) {
+      auto D = det_t{Delta_block_adaptor{Delta}, 100, n_delayed};
+      std::cout << ", delayed (" << n_delayed << ") " << time_per_try(D, order, n_tries, n_measure);
+    }
+    auto D_small = det_t{Delta_block_adaptor{Delta}, 100, 0, 1000}; // Always small
+    std::cout << ", small " << time_per_try(D_small, order, n_tries, n_measure) << std::endl;
+  }
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+// Time per move-like update of a seglist, for std::vector and chunked_list.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <triqs_ctseg/configuration.hpp>
+
+using namespace triqs_ctseg;
+
+// Insertion at the ordered position, erasure at a random one and a traversal, as in the moves
+template <typename L> double time_per_move(long n, long n_moves) {
+  std::mt19937_64 rng(1);
+  L sl;
+  auto insert = [&]() {
+    auto s = segment_t{tau_t{rng()}, tau_t::zero()};
+    sl.insert(std::upper_bound(sl.begin(), sl.end(), s), s);
+  };
+  for (long i = 0; i < n; ++i) insert();
+  double acc = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long m = 0; m < n_moves; ++m) {
+    insert();
+    sl.erase(sl.begin() + long(rng() % sl.size()));
+    for (auto const &s : sl) acc += double(s.length());
+  }
+  std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+  if (acc <= 0) std::cout << "Unexpected sum of the lengths\n";
+  return t.count() / double(n_moves) * 1e9;
+}
+
+int main() {
+  tau_t::set_beta(10);
+  for (long n : {10, 100, 500, 2000, 10000})
+    std::cout << "n = " << n << " segments, time per move (ns): std::vector "
+              << time_per_move<std::vector<segment_t>>(n, 2000) << ", chunked_list "
+              << time_per_move<chunked_list<segment_t>>(n, 2000) << std::endl;
+}
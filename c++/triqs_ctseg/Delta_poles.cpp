@@ -0,0 +1,158 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include "Delta_poles.hpp"
+#include <numeric>
+#include <algorithm>
+#include "logs.hpp"
+
+namespace triqs_ctseg {
+
+  namespace {
+
+    // Least-squares solution of A x = b for n_rhs right-hand sides, by Householder QR with column pivoting.
+    // A is m x n and B is m x n_rhs, both column-major. They are overwritten.
+    // The QR stops at the first pivot smaller than rcond times the first one: the remaining columns of A are
+    // (numerically) spanned by the selected ones, and their coefficients are set to 0.
+    // Returns X, n x n_rhs, column-major.
+    std::vector<double> least_squares(std::vector<double> &A, long m, long n, std::vector<double> &B, long n_rhs,
+                                      double rcond) {
+      std::vector<long> perm(n);
+      std::iota(perm.begin(), perm.end(), 0);
+      std::vector<double> v(m);
+      double first_pivot = 0;
+      long rank          = 0;
+
+      for (long k = 0; k < std::min(m, n); ++k) {
+        // Pivot: the remaining column with the largest norm (rows k:m)
+        long j_max      = k;
+        double norm_max = -1;
+        for (long j = k; j < n; ++j) {
+          double norm2 = 0;
+          for (long i = k; i < m; ++i) norm2 += A[j * m + i] * A[j * m + i];
+          if (norm2 > norm_max) {
+            norm_max = norm2;
+            j_max    = j;
+          }
+        }
+        norm_max = std::sqrt(norm_max);
+        if (k == 0) first_pivot = norm_max;
+        if (norm_max <= rcond * first_pivot or norm_max == 0) break;
+        if (j_max != k) {
+          std::swap_ranges(A.begin() + k * m, A.begin() + (k + 1) * m, A.begin() + j_max * m);
+          std::swap(perm[k], perm[j_max]);
+        }
+
+        // Householder reflection H = 1 - 2 v v^T / (v^T v) that sends A(k:m, k) to (alpha, 0, ..., 0)
+        double alpha = (A[k * m + k] > 0 ? -norm_max : norm_max);
+        for (long i = k; i < m; ++i) v[i] = A[k * m + i];
+        v[k] -= alpha;
+        double vv = 0;
+        for (long i = k; i < m; ++i) vv += v[i] * v[i];
+        auto apply = [&](double *col) {
+          double dot = 0;
+          for (long i = k; i < m; ++i) dot += v[i] * col[i];
+          dot *= 2 / vv;
+          for (long i = k; i < m; ++i) col[i] -= dot * v[i];
+        };
+        if (vv > 0) {
+          for (long j = k + 1; j < n; ++j) apply(A.data() + j * m);
+          for (long r = 0; r < n_rhs; ++r) apply(B.data() + r * m);
+        }
+        A[k * m + k] = alpha;
+        rank         = k + 1;
+      }
+
+      // Back substitution R x = Q^T b on the first rank columns
+      std::vector<double> X(n * n_rhs, 0.0), z(rank);
+      for (long r = 0; r < n_rhs; ++r) {
+        for (long k = rank - 1; k >= 0; --k) {
+          double s = B[r * m + k];
+          for (long j = k + 1; j < rank; ++j) s -= A[j * m + k] * z[j];
+          z[k] = s / A[k * m + k];
+        }
+        for (long k = 0; k < rank; ++k) X[r * n + perm[k]] = z[k];
+      }
+      return X;
+    }
+
+  } // namespace
+
+  Delta_poles_t fit_Delta_poles(gf_const_view<imtime, matrix_real_valued> Delta, int n_poles, double energy_max) {
+
+    double beta = Delta.mesh().beta();
+    long n_tau  = Delta.mesh().size();
+    long n1     = Delta.target_shape()[0];
+    long n2     = Delta.target_shape()[1];
+    ALWAYS_EXPECTS((n_poles >= 3), "Error: the pole fit of Delta(tau) needs at least 3 poles, got {}", n_poles);
+    ALWAYS_EXPECTS((energy_max > 0), "Error: the largest pole energy must be positive, got {}", energy_max);
+
+    // Pole energies: 0 and +/- a geometric sequence of ratio 2^(1/n_chains), the smallest such ratio which still
+    // spans [min(0.1/beta, energy_max), energy_max], so that the exponentials can be computed by squaring
+    Delta_poles_t res;
+    long n_half       = (n_poles - 1) / 2;
+    double energy_min = std::min(0.1 / beta, energy_max);
+    if (n_half > 1) {
+      double ratio  = std::pow(energy_max / energy_min, 1.0 / double(n_half - 1));
+      res.n_chains  = std::max(1l, long(std::floor(std::log(2.0) / std::log(ratio))));
+      res.n_chains  = std::min(res.n_chains, n_half);
+    }
+    double ratio = std::pow(2.0, 1.0 / double(res.n_chains));
+    res.energies = {0.0};
+    for (long i = 0; i < n_half; ++i) {
+      // e_i = energy_max / ratio^(n_half - 1 - i), with exact doubling along a chain
+      double e = (i < res.n_chains) ? energy_max / std::pow(ratio, double(n_half - 1 - i)) :
+                                      2 * res.energies[2 * (i - res.n_chains) + 1];
+      res.energies.push_back(e);
+      res.energies.push_back(-e);
+    }
+    long np = res.n_poles();
+    for (auto eps : res.energies) res.shifts.push_back(eps >= 0 ? 0 : beta);
+
+    // The exponentials and Delta_ab(tau) on the mesh of Delta
+    auto tau_i = [&](long i) { return double(i) * beta / double(n_tau - 1); };
+    std::vector<double> A(n_tau * np), B(n_tau * n1 * n2);
+    for (long p = 0; p < np; ++p)
+      for (long i = 0; i < n_tau; ++i) A[p * n_tau + i] = std::exp(-res.energies[p] * (tau_i(i) - res.shifts[p]));
+    auto A_copy = A;
+    for (long k = 0; k < n1 * n2; ++k)
+      for (long i = 0; i < n_tau; ++i) B[k * n_tau + i] = Delta.data()(i, k / n2, k % n2);
+    auto B_copy = B;
+
+    // Fit. X is column-major np x n_rhs, i.e. X[k * np + p] = c_{k,p}
+    auto X = least_squares(A, n_tau, np, B, n1 * n2, 1.e-15);
+
+    // Maximum error on the mesh
+    for (long k = 0; k < n1 * n2; ++k)
+      for (long i = 0; i < n_tau; ++i) {
+        double fit = 0;
+        for (long p = 0; p < np; ++p) fit += X[k * np + p] * A_copy[p * n_tau + i];
+        res.max_error = std::max(res.max_error, std::abs(fit - B_copy[k * n_tau + i]));
+      }
+
+    // Keep only the poles selected by the QR, i.e. with a non-zero coefficient for some k
+    for (long p = 0; p < np; ++p) {
+      bool is_zero = true;
+      for (long k = 0; k < n1 * n2; ++k) is_zero = is_zero and (X[k * np + p] == 0);
+      if (not is_zero) res.kept.push_back(p);
+    }
+    for (long k = 0; k < n1 * n2; ++k)
+      for (auto p : res.kept) res.coefficients.push_back(X[k * np + p]);
+    return res;
+  }
+
+} // namespace triqs_ctseg
@@ -0,0 +1,93 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#pragma once
+#include <vector>
+#include <cmath>
+#include <triqs/gfs.hpp>
+
+#include "./tau_t.hpp"
+
+using namespace triqs::gfs;
+using namespace triqs::mesh;
+
+namespace triqs_ctseg {
+
+  /**
+   * Pole (sum of exponentials) representation of the hybridization function of a block
+   *
+   *   $\Delta_{ab}(\tau) = \sum_p c_{ab,p} \exp(-\epsilon_p (\tau - s_p))$,
+   *
+   * with $s_p = 0$ if $\epsilon_p \ge 0$ and $s_p = \beta$ otherwise, so that every exponential is bounded by 1.
+   * The element (a, b) is the function k = a * block_size + b, as in interp_table_t.
+   * The evaluation cost is independent of the size of the tau mesh of Delta(tau).
+   *
+   * The energies are 0 and $\pm e_i$, with $e_{i + n_{chains}} = 2 e_i$, stored as {0, e_0, -e_0, e_1, -e_1, ...}.
+   * Only the exponentials of the first n_chains energies of each sign are computed with std::exp, the others by
+   * squaring. The poles discarded by the fit are dropped from the sum.
+   */
+  struct Delta_poles_t {
+    std::vector<double> energies; // Pole energies $\epsilon_p$
+    std::vector<double> shifts;   // $s_p$
+    long n_chains = 1;            // Number of chains of doubling energies, for each sign
+    std::vector<long> kept;       // The poles with a non-zero coefficient
+    std::vector<double> coefficients; // coefficients[k * kept.size() + j] = $c_{k,p}$ for p = kept[j]
+    double max_error = 0;             // Maximum deviation from the fitted Delta(tau) on its mesh
+
+    [[nodiscard]] long n_poles() const { return long(energies.size()); }
+
+    /// $\exp(-\epsilon_p (\tau - s_p))$ for all the poles, in x
+    void exponentials(double t, double *x) const {
+      double beta = double(tau_t::beta());
+      long np     = n_poles();
+      x[0]        = 1;
+      for (long p = 1; p < np; p += 2) {
+        if (p < 1 + 2 * n_chains) {
+          x[p]     = std::exp(-energies[p] * t);
+          x[p + 1] = std::exp(energies[p + 1] * (beta - t));
+        } else {
+          x[p]     = x[p - 2 * n_chains] * x[p - 2 * n_chains];
+          x[p + 1] = x[p + 1 - 2 * n_chains] * x[p + 1 - 2 * n_chains];
+        }
+      }
+    }
+
+    /// $\Delta_k(\tau)$
+    double operator()(long k, tau_t const &tau) const {
+      x_buffer.resize(n_poles());
+      exponentials(double(tau), x_buffer.data());
+      long nk         = long(kept.size());
+      double const *c = coefficients.data() + k * nk;
+      double res      = 0;
+      for (long j = 0; j < nk; ++j) res += c[j] * x_buffer[kept[j]];
+      return res;
+    }
+
+    private:
+    mutable std::vector<double> x_buffer;
+  };
+
+  /**
+   * Least-squares fit of Delta(tau) on a fixed set of n_poles real poles (rounded down to an odd number):
+   * $\epsilon = 0$ and $\pm$ a geometric sequence up to energy_max, down to $0.1/\beta$ at least,
+   * with a ratio $2^{1/n_{chains}}$.
+   * Nearly linearly dependent exponentials are discarded (rank-revealing QR), so that the fit is stable.
+   * The quality of the fit is reported in max_error.
+   */
+  Delta_poles_t fit_Delta_poles(gf_const_view<imtime, matrix_real_valued> Delta, int n_poles, double energy_max);
+
+} // namespace triqs_ctseg
@@ -0,0 +1,124 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include "K_channels.hpp"
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace triqs_ctseg {
+
+  namespace {
+    using vec_t = std::vector<double>;
+
+    double dot(vec_t const &x, vec_t const &y) {
+      double res = 0;
+      for (long i = 0; i < long(x.size()); ++i) res += x[i] * y[i];
+      return res;
+    }
+
+    double max_abs(vec_t const &x) {
+      double res = 0;
+      for (auto y : x) res = std::max(res, std::abs(y));
+      return res;
+    }
+  } // namespace
+
+  K_channels_t factorize_K(gf_const_view<imtime> K, double tolerance) {
+    long n_tau   = K.mesh().size();
+    long n_color = K.target_shape()[0];
+    long n_pairs = n_color * n_color;
+    auto const &d = K.data();
+
+    // g[c1 * n_color + c2] = K_{c1 c2} on the mesh
+    std::vector<vec_t> g(n_pairs, vec_t(n_tau));
+    for (long p = 0; p < n_pairs; ++p)
+      for (long i = 0; i < n_tau; ++i) g[p][i] = std::real(d(i, p / n_color, p % n_color));
+
+    // 1. Orthonormal basis f_k of the K_{c1 c2}: Gram-Schmidt, taking at each step the largest residual
+    auto r = g;
+    std::vector<vec_t> basis;
+    while (long(basis.size()) < n_pairs) {
+      long best = 0;
+      double best_norm = 0, res_max = 0;
+      for (long p = 0; p < n_pairs; ++p) {
+        res_max     = std::max(res_max, max_abs(r[p]));
+        double norm = std::sqrt(dot(r[p], r[p]));
+        if (norm > best_norm) {
+          best      = p;
+          best_norm = norm;
+        }
+      }
+      if (res_max < 0.1 * tolerance) break;
+      auto e = r[best];
+      for (auto &x : e) x /= best_norm;
+      for (auto &rp : r) {
+        double c = dot(e, rp);
+        for (long i = 0; i < n_tau; ++i) rp[i] -= c * e[i];
+      }
+      basis.push_back(std::move(e));
+    }
+    long n_basis = long(basis.size());
+
+    // 2. Decompose the color matrix A_{c1 c2} = <f_k, K_{c1 c2}> of each f_k into rank-1 terms u v^T
+    std::vector<vec_t> us, vs;
+    std::vector<long> f_of_channel;
+    for (long k = 0; k < n_basis; ++k) {
+      vec_t A(n_pairs);
+      for (long p = 0; p < n_pairs; ++p) A[p] = dot(basis[k], g[p]);
+      double scale = max_abs(basis[k]);
+      for (long n = 0; n < n_color; ++n) {
+        // Pivot: largest element of the remainder
+        long piv = std::max_element(A.begin(), A.end(), [](double x, double y) { return std::abs(x) < std::abs(y); })
+           - A.begin();
+        if (std::abs(A[piv]) * scale * n_basis < 0.1 * tolerance) break;
+        long i = piv / n_color, j = piv % n_color;
+        vec_t u(n_color), v(n_color);
+        for (long c = 0; c < n_color; ++c) {
+          u[c] = A[c * n_color + j] / A[piv];
+          v[c] = A[i * n_color + c];
+        }
+        for (long c1 = 0; c1 < n_color; ++c1)
+          for (long c2 = 0; c2 < n_color; ++c2) A[c1 * n_color + c2] -= u[c1] * v[c2];
+        us.push_back(std::move(u));
+        vs.push_back(std::move(v));
+        f_of_channel.push_back(k);
+      }
+    }
+
+    long n_channels = long(us.size());
+    K_channels_t res{interp_table_t(n_channels, n_color, n_tau), nda::matrix<double>(n_channels, n_color)};
+    for (long ch = 0; ch < n_channels; ++ch) {
+      auto const &f = basis[f_of_channel[ch]];
+      for (long c = 0; c < n_color; ++c) {
+        res.u(ch, c) = us[ch][c];
+        res.K_v.set(ch * n_color + c, [&](long i) { return vs[ch][c] * f[i]; });
+      }
+    }
+
+    // Quality of the factorization on the mesh
+    for (long p = 0; p < n_pairs; ++p)
+      for (long i = 0; i < n_tau; ++i) {
+        double val = 0;
+        for (long ch = 0; ch < n_channels; ++ch)
+          val += us[ch][p / n_color] * vs[ch][p % n_color] * basis[f_of_channel[ch]][i];
+        res.max_error = std::max(res.max_error, std::abs(val - g[p][i]));
+      }
+    return res;
+  }
+
+} // namespace triqs_ctseg
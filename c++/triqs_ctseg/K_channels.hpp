@@ -0,0 +1,64 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#pragma once
+#include <triqs/gfs.hpp>
+
+#include "./interpolation.hpp"
+
+using namespace triqs::gfs;
+using namespace triqs::mesh;
+
+namespace triqs_ctseg {
+
+  /**
+   * Channel factorization of the dynamical interaction kernel
+   *
+   *   $K_{c_1 c_2}(\tau) = \sum_k u_{k c_1} v_{k c_2} f_k(\tau)$.
+   *
+   * The functions $v_{k c_2} f_k(\tau)$ are tabulated in K_v (an n_channels x n_color table), so that the
+   * K overlap of a segment of color $c_1$ with all the segments of the configuration is
+   *
+   *   $\sum_k u_{k c_1} \sum_{c_2}$ K_overlap(seglist[c_2], $\tau_c$, $\tau_{c^\dagger}$, K_v, k, $c_2$),
+   *
+   * i.e. the operators are summed in a few channels (typically a single charge channel $f(\tau)$ with
+   * $u = v = 1$ when the screening is color independent) instead of in n_color x n_color pairs.
+   * Evaluated directly, this costs as many kernel evaluations as the sum over the colors $c_2$ (times
+   * n_channels), so the factorization is only used for the retarded field (see K_field.hpp): there is one field
+   * per channel instead of one per color, which makes its update O(n_channels x n_tau) and K_v is smaller
+   * than K.
+   */
+  struct K_channels_t {
+    interp_table_t K_v;    // K_v(k, c2, tau) = $v_{k c_2} f_k(\tau)$
+    nda::matrix<double> u; // u(k, c1) = $u_{k c_1}$
+    double max_error = 0;  // Maximum deviation from K on its mesh
+
+    [[nodiscard]] long n_channels() const { return u.extent(0); }
+  };
+
+  /**
+   * Detect a channel factorization of K (real part), discarding the contributions smaller than tolerance.
+   *
+   * The functions $K_{c_1 c_2}$ are first reduced to an orthonormal basis $f_k$ (Gram-Schmidt with pivoting),
+   * then the color matrix of coefficients of each $f_k$ is decomposed into rank-1 terms $u_k v_k^T$
+   * (cross approximation with full pivoting). The factorization is exact (up to tolerance) but not
+   * necessarily minimal: the number of channels is only small when K is low-rank in color space.
+   * The quality of the factorization is reported in max_error.
+   */
+  K_channels_t factorize_K(gf_const_view<imtime> K, double tolerance);
+
+} // namespace triqs_ctseg
@@ -0,0 +1,42 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include "K_field.hpp"
+#include <cmath>
+
+namespace triqs_ctseg {
+
+  void K_field_t::add_segment(interp_table_t const &K, int color, tau_t const &tau_c, tau_t const &tau_cdag,
+                              double sign) {
+    long n_tau = n_intervals + 1;
+    for (long c1 = 0; c1 < n_fields; ++c1) {
+      auto Kf = K.function(c1, color);
+      double *p = phi.data() + c1 * n_tau;
+      for (long k = 0; k < n_tau; ++k) {
+        auto tau = tau_t::grid_point(k, n_intervals);
+        p[k] += sign * (Kf(tau - tau_c) - Kf(tau - tau_cdag));
+      }
+    }
+  }
+
+  double K_field_t::max_difference(K_field_t const &f) const {
+    double res = 0;
+    for (long i = 0; i < long(phi.size()); ++i) res = std::max(res, std::abs(phi[i] - f.phi[i]));
+    return res;
+  }
+
+} // namespace triqs_ctseg
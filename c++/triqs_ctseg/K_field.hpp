@@ -0,0 +1,81 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#pragma once
+#include <vector>
+#include <itertools/itertools.hpp>
+#include "./tau_t.hpp"
+#include "./interpolation.hpp"
+
+namespace triqs_ctseg {
+
+  /**
+   * Retarded field of the dynamical interaction
+   *
+   *   $\phi_{c_1}(\tau) = \sum_{c_2} \sum_{s \in \text{seglist}[c_2]} [K_{c_1 c_2}(\tau - \tau_c(s)) - K_{c_1 c_2}(\tau - \tau_{c^\dagger}(s))]$
+   *
+   * tabulated on a uniform grid of $[0,\beta]$, so that the K contribution of a segment of color $c_1$ is
+   *
+   *   $\sum_{c_2}$ K_overlap(seglist[c_2], $\tau_c$, $\tau_{c^\dagger}$, K, $c_1$, $c_2$) = $\phi_{c_1}(\tau_c) - \phi_{c_1}(\tau_{c^\dagger})$
+   *
+   * up to the interpolation error. The evaluation is O(1) instead of O(number of segments x number of colors),
+   * while the field must be updated (in O(n_color x n_tau)) each time operators are added to or removed from the
+   * configuration, i.e. in the accept of the moves.
+   *
+   * The field can also be built from the channel table K_v of a K_channels_t (see K_channels.hpp), with one field
+   * per channel $k$ instead of one per color. The update is then in O(n_channels x n_tau).
+   */
+  class K_field_t {
+    long n_fields    = 0;    // Number of colors c1 (or channels)
+    long n_intervals = 1;    // Number of intervals of the grid
+    std::vector<double> phi; // phi[c1 * (n_intervals + 1) + k] = phi_c1(tau_k)
+
+    public:
+    K_field_t() = default;
+
+    /// Zero field for n_fields colors (or channels) on a grid of n_tau points
+    K_field_t(long n_fields_, long n_tau) : n_fields(n_fields_), n_intervals(n_tau - 1), phi(n_fields_ * n_tau, 0.0) {}
+
+    /// Add sign * [K_{c1 color}(tau - tau_c) - K_{c1 color}(tau - tau_cdag)] to phi_c1 for all c1, i.e.
+    /// add (sign = 1) or remove (sign = -1) a c at tau_c and a cdag at tau_cdag in color.
+    void add_segment(interp_table_t const &K, int color, tau_t const &tau_c, tau_t const &tau_cdag, double sign);
+
+    /// $\phi_{c_1}(\tau)$ (linear interpolation)
+    double operator()(int c1, tau_t const &tau) const {
+      double x        = tau.grid_position(n_intervals);
+      long i          = std::min(long(x), n_intervals - 1);
+      double const *p = phi.data() + c1 * (n_intervals + 1) + i;
+      return p[0] + (x - double(i)) * (p[1] - p[0]);
+    }
+
+    /// Sum over c2 of the K_overlap of a segment [tau_c, tau_cdag] of color c1 with seglist[c2]
+    double overlap(int c1, tau_t const &tau_c, tau_t const &tau_cdag) const {
+      return (*this)(c1, tau_c) - (*this)(c1, tau_cdag);
+    }
+
+    /// Recompute the field of the seglists from scratch
+    void reset(interp_table_t const &K, auto const &seglists) {
+      std::fill(phi.begin(), phi.end(), 0.0);
+      for (auto const &[c, sl] : itertools::enumerate(seglists))
+        for (auto const &s : sl) add_segment(K, int(c), s.tau_c, s.tau_cdag, 1);
+    }
+
+    /// Maximum difference with the values of another field on the grid
+    [[nodiscard]] double max_difference(K_field_t const &f) const;
+  };
+
+} // namespace triqs_ctseg
@@ -0,0 +1,187 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <initializer_list>
+
+namespace triqs_ctseg {
+
+  /**
+   * An ordered sequence with (almost) the interface of std::vector, stored as a list of chunks of
+   * B to 2B elements, with the index of the first element of each chunk.
+   *
+   * Insertion and erasure in the middle move O(B) elements and update O(n / B) chunk indices,
+   * instead of moving O(n) elements. The random access by index is a binary search on the chunks,
+   * and the iterators remember their chunk, so that a sequential traversal does not search.
+   *
+   * Used as the container of the segments if CHUNKED_SEGLISTS is defined, cf seglist_t.
+   */
+  template <typename T, long B = 64> class chunked_list {
+
+    std::vector<std::vector<T>> chunks = {{}}; // Never empty. Only chunks[0] can be empty, iif the list is.
+    std::vector<long> first            = {0};  // first[k] = index of the first element of chunks[k]
+    long n                             = 0;    // Number of elements
+
+    // Chunk containing the index i. i = n is in the last chunk.
+    [[nodiscard]] long chunk_of(long i) const {
+      return std::upper_bound(first.begin() + 1, first.end(), i) - first.begin() - 1;
+    }
+
+    template <bool Const> class iterator_impl {
+      using list_t = std::conditional_t<Const, chunked_list const, chunked_list>;
+      list_t *l    = nullptr;
+      long i       = 0;      // Index of the element
+      mutable long k = 0;    // Chunk of the element (a hint, updated when dereferenced)
+      friend class chunked_list;
+
+      [[nodiscard]] bool in_chunk(long kk) const {
+        return kk < long(l->chunks.size()) and i >= l->first[kk] and i < l->first[kk] + long(l->chunks[kk].size());
+      }
+
+      public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type        = T;
+      using difference_type   = long;
+      using pointer           = std::conditional_t<Const, T const *, T *>;
+      using reference         = std::conditional_t<Const, T const &, T &>;
+
+      iterator_impl() = default;
+      iterator_impl(list_t *l_, long i_, long k_ = 0) : l(l_), i(i_), k(k_) {}
+      // iterator -> const_iterator
+      template <bool C>
+        requires(Const and not C)
+      iterator_impl(iterator_impl<C> const &it) : l(it.l), i(it.i), k(it.k) {}
+
+      reference operator*() const {
+        if (not in_chunk(k)) k = in_chunk(k + 1) ? k + 1 : l->chunk_of(i);
+        return l->chunks[k][i - l->first[k]];
+      }
+      pointer operator->() const { return &(**this); }
+      reference operator[](long d) const { return *(*this + d); }
+
+      iterator_impl &operator++() { return ++i, *this; }
+      iterator_impl &operator--() { return --i, *this; }
+      iterator_impl operator++(int) { return {l, i++, k}; }
+      iterator_impl operator--(int) { return {l, i--, k}; }
+      iterator_impl &operator+=(long d) { return i += d, *this; }
+      iterator_impl &operator-=(long d) { return i -= d, *this; }
+      friend iterator_impl operator+(iterator_impl it, long d) { return it += d; }
+      friend iterator_impl operator+(long d, iterator_impl it) { return it += d; }
+      friend iterator_impl operator-(iterator_impl it, long d) { return it -= d; }
+      friend long operator-(iterator_impl const &a, iterator_impl const &b) { return a.i - b.i; }
+
+      bool operator==(iterator_impl const &it) const { return i == it.i; }
+      auto operator<=>(iterator_impl const &it) const { return i <=> it.i; }
+
+      friend class iterator_impl<true>;
+    };
+
+    public:
+    using value_type      = T;
+    using size_type       = long;
+    using iterator        = iterator_impl<false>;
+    using const_iterator  = iterator_impl<true>;
+    using reference       = T &;
+    using const_reference = T const &;
+
+    chunked_list() = default;
+
+    /// List of count default constructed elements
+    explicit chunked_list(long count) {
+      for (long i = 0; i < count; ++i) push_back(T{});
+    }
+
+    chunked_list(std::initializer_list<T> l) {
+      for (auto const &x : l) push_back(x);
+    }
+
+    [[nodiscard]] long size() const { return n; }
+    [[nodiscard]] bool empty() const { return n == 0; }
+
+    T &operator[](long i) {
+      long k = chunk_of(i);
+      return chunks[k][i - first[k]];
+    }
+    T const &operator[](long i) const {
+      long k = chunk_of(i);
+      return chunks[k][i - first[k]];
+    }
+
+    T &front() { return chunks.front().front(); }
+    T const &front() const { return chunks.front().front(); }
+    T &back() { return chunks.back().back(); }
+    T const &back() const { return chunks.back().back(); }
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, n, long(chunks.size()) - 1}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, n, long(chunks.size()) - 1}; }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    friend iterator begin(chunked_list &l) { return l.begin(); }
+    friend iterator end(chunked_list &l) { return l.end(); }
+    friend const_iterator begin(chunked_list const &l) { return l.begin(); }
+    friend const_iterator end(chunked_list const &l) { return l.end(); }
+
+    /// Insert x before pos. Returns an iterator on the inserted element.
+    iterator insert(const_iterator pos, T const &x) {
+      long i = pos.i, k = chunk_of(i);
+      auto &ch = chunks[k];
+      ch.insert(ch.begin() + (i - first[k]), x);
+      ++n;
+      for (long j = k + 1; j < long(chunks.size()); ++j) ++first[j];
+      // Split a chunk which is too large
+      if (long(ch.size()) > 2 * B) {
+        std::vector<T> second(ch.begin() + B, ch.end());
+        ch.resize(B);
+        chunks.insert(chunks.begin() + k + 1, std::move(second));
+        first.insert(first.begin() + k + 1, first[k] + B);
+      }
+      return {this, i};
+    }
+
+    /// Erase the element at pos. Returns an iterator on the next element.
+    iterator erase(const_iterator pos) {
+      long i = pos.i, k = chunk_of(i);
+      auto &ch = chunks[k];
+      ch.erase(ch.begin() + (i - first[k]));
+      --n;
+      for (long j = k + 1; j < long(chunks.size()); ++j) --first[j];
+      // Remove an empty chunk, or merge a small one with the next
+      if (ch.empty() and chunks.size() > 1) {
+        chunks.erase(chunks.begin() + k);
+        first.erase(first.begin() + k);
+      } else if (k + 1 < long(chunks.size()) and long(ch.size() + chunks[k + 1].size()) <= B) {
+        ch.insert(ch.end(), chunks[k + 1].begin(), chunks[k + 1].end());
+        chunks.erase(chunks.begin() + k + 1);
+        first.erase(first.begin() + k + 1);
+      }
+      return {this, i};
+    }
+
+    void push_back(T const &x) { insert(end(), x); }
+
+    void clear() { *this = chunked_list{}; }
+
+    bool operator==(chunked_list const &l) const { return n == l.n and std::equal(begin(), end(), l.begin()); }
+  };
+
+} // namespace triqs_ctseg
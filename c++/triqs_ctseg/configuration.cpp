@@ -72,9 +72,9 @@ namespace triqs_ctseg {
     return double(tau_start - tau_end);
   };
 
-  // =================== Functions to manipulate std::vector<segment_t> ========
+  // =================== Functions to manipulate seglist_t ========
 
-  vec_seg_iter_t lower_bound(std::vector<segment_t> const &seglist, tau_t const &tau) {
+  vec_seg_iter_t lower_bound(seglist_t const &seglist, tau_t const &tau) {
     // comparison is s.tau > tau as in the tau_t comparison
     return std::lower_bound(seglist.begin(), seglist.end(), tau, [](auto &&s, auto &&t) { return s.tau_c > t; });
   }
@@ -84,14 +84,14 @@ namespace triqs_ctseg {
   // Iterator on the closest segment on the left of seg.
   // If there is none, returns the first on the right (or end)
   // the list shoud not be empty
-  vec_seg_iter_t find_segment_left(std::vector<segment_t> const &seglist, segment_t const &seg) {
+  vec_seg_iter_t find_segment_left(seglist_t const &seglist, segment_t const &seg) {
     auto seg_iter = std::upper_bound(seglist.begin(), seglist.end(), seg);
     return (seg_iter == seglist.begin()) ? seg_iter : --seg_iter;
   }
 
   // ---------------------------
 
-  int n_at_boundary(std::vector<segment_t> const &sl) {
+  int n_at_boundary(seglist_t const &sl) {
     if (sl.empty()) return 0;
     return (is_cyclic(sl.back()) or is_full_line(sl.back())) ? 1 : 0;
   }
@@ -99,7 +99,7 @@ namespace triqs_ctseg {
   // ---------------------------
 
   // Find density in seglist to the right of time tau.
-  int n_tau(tau_t const &tau, std::vector<segment_t> const &seglist) {
+  int n_tau(tau_t const &tau, seglist_t const &seglist) {
     if (seglist.empty()) return 0;
     auto it = find_segment_left(seglist, segment_t{tau, tau});
     return (tau_in_seg(tau, *it) or tau_in_seg(tau, seglist.back())) ? 1 : 0;
@@ -107,7 +107,7 @@ namespace triqs_ctseg {
 
   // ---------------------------
   // Flip seglist
-  std::vector<segment_t> flip(std::vector<segment_t> const &sl) {
+  seglist_t flip(seglist_t const &sl) {
     if (sl.empty()) // Flipped seglist is full line
       return {segment_t::full_line()};
 
@@ -115,7 +115,7 @@ namespace triqs_ctseg {
       return {};
 
     long N   = sl.size();
-    auto fsl = std::vector<segment_t>(N); // NB must be () here, not {} !
+    auto fsl = seglist_t(N); // NB must be () here, not {} !
     if (is_cyclic(sl.back()))
       for (auto i : range(N)) {
         long ind = (i == 0) ? N - 1 : i - 1;
@@ -131,8 +131,70 @@ namespace triqs_ctseg {
 
   // ---------------------------
 
+  // Index of the segment which contains tau, if any. The list must not be empty.
+  // It is the last segment with tau_c > tau, or the last one (cyclic) if there is none.
+  long segment_around(seglist_t const &seglist, tau_t const &tau) {
+    long idx = long(lower_bound(seglist, tau) - seglist.begin()) - 1;
+    return (idx < 0) ? long(seglist.size()) - 1 : idx;
+  }
+
+  // ---------------------------
+
+  bool is_inside(segment_t const &seg, seglist_t const &seglist) {
+    if (seglist.empty()) return false;
+    if (is_full_line(seglist[0])) return true;
+    if (is_full_line(seg)) return false;
+    // Position of the times of seg from the cdag of the segment S around seg.tau_c, going up (cyclically) :
+    // S is [0, L] and seg must be in ]0, L[
+    auto const &S = seglist[segment_around(seglist, seg.tau_c)];
+    auto L        = S.length();
+    auto d_c      = seg.tau_c - S.tau_cdag;
+    auto d_cdag   = seg.tau_cdag - S.tau_cdag;
+    return d_cdag > tau_t::zero() and d_cdag < d_c and d_c < L;
+  }
+
+  // ---------------------------
+
+  void fill_antisegment(seglist_t &seglist, long i) {
+    if (seglist.empty()) { // the antisegment is a full line
+      seglist.push_back(segment_t::full_line());
+      return;
+    }
+    auto [l, r] = flipped_view_t{seglist}.neighbours(i);
+    if (l == r) { // single segment
+      seglist[0] = segment_t::full_line();
+      return;
+    }
+    // The regrouped segment replaces the left one, which has the same tau_c (or is the last one)
+    seglist[l] = segment_t{seglist[l].tau_c, seglist[r].tau_cdag, seglist[l].J_c, seglist[r].J_cdag};
+    seglist.erase(seglist.begin() + r);
+  }
+
+  // ---------------------------
+
+  void cut_antisegment(seglist_t &seglist, segment_t const &seg) {
+    if (is_full_line(seg)) { // the list is a full line
+      seglist.clear();
+      return;
+    }
+    if (is_full_line(seglist[0])) {
+      seglist[0] = flip(seg);
+      return;
+    }
+    // cf split_segment
+    long idx       = segment_around(seglist, seg.tau_c);
+    auto S         = seglist[idx];
+    auto seg_left  = segment_t{S.tau_c, seg.tau_c, S.J_c, false};
+    auto seg_right = segment_t{seg.tau_cdag, S.tau_cdag, false, S.J_cdag};
+    seglist[idx]   = seg_left;
+    bool insert_at_front = is_cyclic(S) and not is_cyclic(seg_right);
+    seglist.insert(seglist.begin() + (insert_at_front ? 0 : idx + 1), seg_right);
+  }
+
+  // ---------------------------
+
   // Overlap between segment and a list of segments.
-  double overlap(std::vector<segment_t> const &seglist, segment_t const &seg) {
+  double overlap(seglist_t const &seglist, segment_t const &seg) {
     if (seglist.empty()) return 0;
     // If seg is cyclic, need to split it because of the condition in the for later
     if (is_cyclic(seg)) {
@@ -155,8 +217,51 @@ namespace triqs_ctseg {
 
   // ---------------------------
 
+  double overlap(configuration_t const &config, int color, segment_t const &seg) {
+    auto const &sl = config.seglists[color];
+    if (sl.empty()) return 0;
+    if (is_cyclic(seg)) {
+      auto [s_left, s_right] = split_cyclic_segment(seg);
+      return overlap(config, color, s_left) + overlap(config, color, s_right);
+    }
+    auto const &occ = config.occupancy[color];
+    return double(occ.occupied_above(sl, seg.tau_cdag) - occ.occupied_above(sl, seg.tau_c));
+  }
+
+  // =================== Occupancy index ========================
+
+  void occupancy_index_t::reset(seglist_t const &seglist) {
+    bool last_cyclic = not seglist.empty() and is_cyclic(seglist.back());
+    long n           = long(seglist.size()) - (last_cyclic ? 1 : 0);
+    cumul.resize(n + 1);
+    for (long i = 0; i < n; ++i) cumul[i + 1] = cumul[i] + seglist[i].length();
+    cyclic_length = last_cyclic ? seglist.back().length() : tau_t::zero();
+  }
+
+  // ---------------------------
+
+  tau_t occupancy_index_t::occupied_above(seglist_t const &seglist, tau_t const &tau) const {
+    auto res = tau_t::zero();
+    if (seglist.empty()) return res;
+    long n = long(cumul.size()) - 1; // number of non-cyclic segments
+    // The last segment, if cyclic, occupies [tau_cdag, beta] and [0, tau_c]
+    if (n < long(seglist.size())) {
+      auto const &s = seglist.back();
+      res           = tau_t::beta() - std::max(tau, s.tau_cdag);
+      if (s.tau_c > tau) res = res + (s.tau_c - tau);
+    }
+    // Segments [0, i[ have tau_c > tau, and are fully above tau except possibly i-1
+    long i = std::partition_point(seglist.begin(), seglist.begin() + n, [&tau](auto const &s) { return s.tau_c > tau; })
+       - seglist.begin();
+    res = res + cumul[i];
+    if (i > 0 and seglist[i - 1].tau_cdag < tau) res = res - (tau - seglist[i - 1].tau_cdag);
+    return res;
+  }
+
+  // ---------------------------
+
   // Checks if segment is insertable to a given color
-  bool is_insertable_into(segment_t const &seg, std::vector<segment_t> const &seglist) {
+  bool is_insertable_into(segment_t const &seg, seglist_t const &seglist) {
     if (seglist.empty()) return true;
 
     // If seg is cyclic, split it
@@ -185,7 +290,7 @@ namespace triqs_ctseg {
   // FIXME : do we have TESTS ???
   // Find the indices of the segments whose cdag are in ]wtau_left,wtau_right[
   std::vector<long> cdag_in_window(tau_t const &wtau_left, tau_t const &wtau_right,
-                                   std::vector<segment_t> const &seglist) {
+                                   seglist_t const &seglist) {
     if (seglist.empty()) return {}; // should never happen, but protect
 
     if (wtau_left < wtau_right) {
@@ -212,16 +317,15 @@ namespace triqs_ctseg {
 
   // Contribution of the dynamical interaction kernel K to the overlap between a segment and a list of segments.
   // Computes the sum of the s_a s_b K(tau_a - tau_b) where s_a is 1 for cdag and - 1 for c
-  double K_overlap(std::vector<segment_t> const &seglist, tau_t const &tau_c, tau_t const &tau_cdag,
-                   gf<imtime, matrix_valued> const &K, int c1, int c2) {
+  double K_overlap(seglist_t const &seglist, tau_t const &tau_c, tau_t const &tau_cdag,
+                   interp_table_t const &K, int c1, int c2) {
 
-    auto Ks = slice_target_to_scalar(K, c1, c2);
+    auto Ks = K.function(c1, c2);
 
     // seglist empty covered by the loop
     double result = 0;
     for (auto const &s : seglist) {
-      result += real(Ks(double(tau_c - s.tau_c)) + Ks(double(tau_cdag - s.tau_cdag)) - Ks(double(tau_cdag - s.tau_c))
-                     - Ks(double(tau_c - s.tau_cdag)));
+      result += Ks(tau_c - s.tau_c) + Ks(tau_cdag - s.tau_cdag) - Ks(tau_cdag - s.tau_c) - Ks(tau_c - s.tau_cdag);
     }
     return result;
   }
@@ -230,21 +334,39 @@ namespace triqs_ctseg {
 
   // Contribution of the dynamical interaction kernel K to the overlap between an operator and a list of segments.
   // Computes the sum of the s_a s_b K(tau_a - tau_b) where s_a is 1 for cdag and - 1 for c
-  double K_overlap(std::vector<segment_t> const &seglist, tau_t const &tau, bool is_c,
-                   gf<imtime, matrix_valued> const &K, int c1, int c2) {
-    auto Ks = slice_target_to_scalar(K, c1, c2);
+  double K_overlap(seglist_t const &seglist, tau_t const &tau, bool is_c, interp_table_t const &K,
+                   int c1, int c2) {
+    auto Ks = K.function(c1, c2);
 
     double result = 0;
     // The order of the times is important for the measure of F
-    for (auto const &s : seglist) { result += real(Ks(double(s.tau_c - tau)) - Ks(double(s.tau_cdag - tau))); }
+    for (auto const &s : seglist) { result += Ks(s.tau_c - tau) - Ks(s.tau_cdag - tau); }
     return is_c ? result : -result;
   }
 
   // ---------------------------
 
+  double K_overlap(configuration_t const &config, tau_t const &tau_c, tau_t const &tau_cdag, int color,
+                   work_data_t const &wdata) {
+    double result = 0;
+    if (wdata.use_K_channels) {
+      // K_{c1 c2} = sum_k u_{k c1} K_v_{k c2}: one field per channel
+      auto const &ch = wdata.K_channels;
+      for (long k = 0; k < ch.n_channels(); ++k)
+        if (ch.u(k, color) != 0) result += ch.u(k, color) * wdata.K_field.overlap(int(k), tau_c, tau_cdag);
+      return result;
+    }
+    if (wdata.use_K_field) return wdata.K_field.overlap(color, tau_c, tau_cdag);
+    for (auto const &[c, sl] : itertools::enumerate(config.seglists))
+      result += K_overlap(sl, tau_c, tau_cdag, wdata.K, color, int(c));
+    return result;
+  }
+
+  // ---------------------------
+
   // List of operators containing all colors.
   // Time are ordered in decreasing order, in agreement with the whole physic literature.
-  std::vector<colored_ops_t> colored_ordered_ops(std::vector<std::vector<segment_t>> const &seglists) {
+  std::vector<colored_ops_t> colored_ordered_ops(std::vector<seglist_t> const &seglists) {
     int c = 0;                           // index of color
     std::vector<colored_ops_t> ops_list; // list of all the operators
     for (auto const &seglist : seglists) {
@@ -266,7 +388,7 @@ namespace triqs_ctseg {
 
   // ===================  PRINTING ========================
 
-  std::ostream &operator<<(std::ostream &out, std::vector<segment_t> const &sl) {
+  std::ostream &operator<<(std::ostream &out, seglist_t const &sl) {
     out << '\n';
     for (auto const &[i, seg] : itertools::enumerate(sl))
       out << ". Position " << i << " : [ J:" << seg.J_c << " " << seg.tau_c << ", " << seg.tau_cdag
@@ -18,6 +18,7 @@
 #pragma once
 #include <vector>
 #include "tau_t.hpp"
+#include "chunked_list.hpp"
 #include "dets.hpp"
 #include "work_data.hpp"
 
@@ -59,8 +60,18 @@ namespace triqs_ctseg {
     static segment_t full_line() { return {tau_t::beta(), tau_t::zero()}; }
   };
 
+  // The list of segments of a color.
+  // A std::vector by default. With CHUNKED_SEGLISTS, a chunked_list, for which the insertion and erasure
+  // in the middle are cheaper, but the traversal a bit slower: it only pays off for very long lists
+  // (~ 1000 segments per color, cf the benchmark in benchmark/c++/seglist.cpp).
+#ifdef CHUNKED_SEGLISTS
+  using seglist_t = chunked_list<segment_t>;
+#else
+  using seglist_t = std::vector<segment_t>;
+#endif
+
   // simple alias
-  using vec_seg_iter_t = std::vector<segment_t>::const_iterator;
+  using vec_seg_iter_t = seglist_t::const_iterator;
 
   // ----------------- Jperp line -------------------
   // Stores the times of a couple (S+, S-)
@@ -78,19 +89,48 @@ namespace triqs_ctseg {
     bool is_cdag;
   };
 
+  // ----------------- Occupancy index -------------------
+  // Cumulative occupied length of a list of segments, so that the occupied length of any interval
+  // (hence the overlap of a segment with the list) is obtained by binary search in O(log n).
+  // It must be reset each time the list changes, cf configuration_t::update_occupancy.
+  class occupancy_index_t {
+    // cumul[i] = total length of the segments 0, ..., i-1, excluding the last one if it is cyclic.
+    // NB : exact (integer) sums, the total occupied length being at most beta.
+    std::vector<tau_t> cumul = {tau_t::zero()};
+    tau_t cyclic_length      = tau_t::zero(); // Length of the last segment if it is cyclic
+
+    public:
+    // Recompute the index for the list
+    void reset(seglist_t const &seglist);
+
+    // Occupied length in [tau, beta]
+    [[nodiscard]] tau_t occupied_above(seglist_t const &seglist, tau_t const &tau) const;
+
+    // Total occupied length
+    [[nodiscard]] tau_t total() const { return cumul.back() + cyclic_length; }
+
+    bool operator==(occupancy_index_t const &) const = default;
+  };
+
   // --------------- Configuration ----------------------
   // The configuration is a list of of segments for each color,
   // and a list of Jperp lines.
   struct configuration_t {
     // A list of segments for each color.
     // NB: ordered in DECREASING time order of the tau_c.
-    std::vector<std::vector<segment_t>> seglists;
+    std::vector<seglist_t> seglists;
 
     // List of Jperp lines, NOT ordered.
     std::vector<Jperp_line_t> Jperp_list;
 
+    // Occupancy index of each seglist. Updated in the accept of the moves.
+    std::vector<occupancy_index_t> occupancy;
+
     // Construct from the number of colors
-    configuration_t(int n_color) : seglists(n_color) {}
+    configuration_t(int n_color) : seglists(n_color), occupancy(n_color) {}
+
+    // Update the occupancy index after a change of seglists[color]
+    void update_occupancy(int color) { occupancy[color].reset(seglists[color]); }
 
     // Number of segments
     long n_segments() const {
@@ -132,58 +172,117 @@ namespace triqs_ctseg {
   // Flip a segment. J are set to default
   inline segment_t flip(segment_t const &s) { return {s.tau_cdag, s.tau_c}; }
 
-  // =================== Functions to manipulate std::vector<segment_t> ========
+  // =================== Functions to manipulate seglist_t ========
 
   // lower_bound : find segment at tau if present or the first after tau
-  vec_seg_iter_t lower_bound(std::vector<segment_t> const &seglist, tau_t const &tau);
+  vec_seg_iter_t lower_bound(seglist_t const &seglist, tau_t const &tau);
 
   // Value of n (= 0 or 1) at tau = beta = 0
   // 1 iif there is a cyclic segment or a full line
-  int n_at_boundary(std::vector<segment_t> const &seglist);
+  int n_at_boundary(seglist_t const &seglist);
 
   // Find density (0 or 1)in seglist to the right of time tau.
-  int n_tau(tau_t const &tau, std::vector<segment_t> const &seglist);
+  int n_tau(tau_t const &tau, seglist_t const &seglist);
 
   // Flip config
-  std::vector<segment_t> flip(std::vector<segment_t> const &sl);
+  seglist_t flip(seglist_t const &sl);
+
+  // A view of flip(sl) without copy : the antisegments of sl, in the same order as in flip(sl).
+  class flipped_view_t {
+    seglist_t const *sl;
+
+    public:
+    explicit flipped_view_t(seglist_t const &sl_) : sl(&sl_) {}
+
+    // Number of antisegments
+    [[nodiscard]] long size() const {
+      if (sl->empty()) return 1; // full line
+      return (sl->size() == 1 and is_full_line((*sl)[0])) ? 0 : long(sl->size());
+    }
+
+    // Indices of the segments of sl on the left and on the right of the antisegment i (sl not empty)
+    [[nodiscard]] std::pair<long, long> neighbours(long i) const {
+      long N = sl->size();
+      if (is_cyclic(sl->back())) return {(i == 0) ? N - 1 : i - 1, i};
+      return {i, (i == N - 1) ? 0 : i + 1};
+    }
+
+    // Antisegment i, i.e. flip(sl)[i]
+    segment_t operator[](long i) const {
+      if (sl->empty()) return segment_t::full_line();
+      auto [l, r]  = neighbours(i);
+      auto const &L = (*sl)[l], &R = (*sl)[r];
+      return {L.tau_cdag, R.tau_c, L.J_cdag, R.J_c};
+    }
+  };
+
+  // Index of the segment which contains tau, if any. The list must not be empty.
+  long segment_around(seglist_t const &seglist, tau_t const &tau);
+
+  // Checks if the antisegment seg is strictly inside one segment of the list,
+  // i.e. if it is insertable into flip(seglist).
+  bool is_inside(segment_t const &seg, seglist_t const &seglist);
+
+  // Remove the antisegment i of seglist (i.e. flip(seglist)[i]), by regrouping the two segments around it.
+  void fill_antisegment(seglist_t &seglist, long i);
+
+  // Insert the antisegment seg into seglist (i.e. seg into flip(seglist)), by splitting the segment around it.
+  // seg must be inside a segment (is_inside).
+  void cut_antisegment(seglist_t &seglist, segment_t const &seg);
 
   // Overlap between segment and a list of segments.
-  double overlap(std::vector<segment_t> const &seglist, segment_t const &seg);
+  double overlap(seglist_t const &seglist, segment_t const &seg);
+
+  // Overlap between segment and config.seglists[color], using the occupancy index. O(log n).
+  double overlap(configuration_t const &config, int color, segment_t const &seg);
 
   // Checks if segment seg can be inserted into the list, i.e. without
   // overlap with other segment.
-  bool is_insertable_into(segment_t const &seg, std::vector<segment_t> const &seglist);
+  bool is_insertable_into(segment_t const &seg, seglist_t const &seglist);
 
   // Find the indices of the segments whose cdag are in ]wtau_left,wtau_right[
   std::vector<long> cdag_in_window(tau_t const &wtau_left, tau_t const &wtau_right,
-                                   std::vector<segment_t> const &seglist);
+                                   seglist_t const &seglist);
 
   // Fix the list after a change of operator c time in some move
   // to restore the invariants
   // 1 -if first segment is cyclic (c has move beyond beta),  put it at end
   // 2- if last segment is such that its tau is > tau of first (c has moved beyond 0), put it first
   // Only useful when # segments > 1
-  inline void fix_ordering_first_last(std::vector<segment_t> &sl) {
+  inline void fix_ordering_first_last(seglist_t &sl) {
     if (sl.size() <= 1) return;
-    if (is_cyclic(sl[0])) std::rotate(begin(sl), begin(sl) + 1, end(sl));
-    if (sl.back().tau_c > sl[0].tau_c) std::rotate(begin(sl), end(sl) - 1, end(sl));
+    if (is_cyclic(sl[0])) {
+      auto s = sl[0];
+      sl.erase(begin(sl));
+      sl.push_back(s);
+    }
+    if (sl.back().tau_c > sl[0].tau_c) {
+      auto s = sl.back();
+      sl.erase(end(sl) - 1);
+      sl.insert(begin(sl), s);
+    }
   }
 
   // Contribution of the dynamical interaction kernel K to the overlap between a segment and a list of segments.
   // Computes the sum of the s_a s_b K(tau_a - tau_b) where s_a is 1 for cdag and - 1 for c
-  double K_overlap(std::vector<segment_t> const &seglist, tau_t const &tau_c, tau_t const &tau_cdag,
-                   gf<imtime, matrix_valued> const &K, int c1, int c2);
+  double K_overlap(seglist_t const &seglist, tau_t const &tau_c, tau_t const &tau_cdag,
+                   interp_table_t const &K, int c1, int c2);
 
   // Contribution of the dynamical interaction kernel K to the overlap between an operator and a list of segments.
-  double K_overlap(std::vector<segment_t> const &seglist, tau_t const &tau, bool is_c,
-                   gf<imtime, matrix_valued> const &K, int c1, int c2);
+  double K_overlap(seglist_t const &seglist, tau_t const &tau, bool is_c, interp_table_t const &K,
+                   int c1, int c2);
+
+  // Sum over the colors c of K_overlap(config.seglists[c], tau_c, tau_cdag, wdata.K, color, c),
+  // read from the retarded field if wdata.use_K_field, with one field per channel of K if wdata.use_K_channels.
+  double K_overlap(configuration_t const &config, tau_t const &tau_c, tau_t const &tau_cdag, int color,
+                   work_data_t const &wdata);
 
   // List of operators containing all colors.
-  std::vector<colored_ops_t> colored_ordered_ops(std::vector<std::vector<segment_t>> const &seglists);
+  std::vector<colored_ops_t> colored_ordered_ops(std::vector<seglist_t> const &seglists);
 
   // ===================  PRINTING ========================
 
-  std::ostream &operator<<(std::ostream &out, std::vector<segment_t> const &sl);
+  std::ostream &operator<<(std::ostream &out, seglist_t const &sl);
 
   std::ostream &operator<<(std::ostream &out, configuration_t const &config);
 
@@ -0,0 +1,694 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include "dets.hpp"
+#include "logs.hpp"
+#include <nda/blas.hpp>
+#include <nda/linalg.hpp>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace triqs_ctseg {
+
+  std::vector<std::vector<long>> Delta_block_components(gf_const_view<imtime, matrix_real_valued> D,
+                                                        double tolerance) {
+    long n         = D.target_shape()[0];
+    auto connected = [&](long a, long b) {
+      return max_element(abs(D.data()(range::all, a, b))) > tolerance
+         or max_element(abs(D.data()(range::all, b, a))) > tolerance;
+    };
+    // Depth-first search from each index not yet in a component
+    std::vector<long> component(n, -1);
+    std::vector<std::vector<long>> result;
+    for (long a0 = 0; a0 < n; ++a0) {
+      if (component[a0] >= 0) continue;
+      long comp = long(result.size());
+      std::vector<long> stack{a0}, idx;
+      component[a0] = comp;
+      while (not stack.empty()) {
+        long a = stack.back();
+        stack.pop_back();
+        idx.push_back(a);
+        for (long b = 0; b < n; ++b)
+          if (component[b] < 0 and connected(a, b)) {
+            component[b] = comp;
+            stack.push_back(b);
+          }
+      }
+      std::sort(idx.begin(), idx.end());
+      result.push_back(std::move(idx));
+    }
+    return result;
+  }
+
+  //--------------------------------------------------
+
+  delayed_det_t::delayed_det_t(Delta_block_adaptor f_, long n_delayed_) : f(std::move(f_)), n_delayed(n_delayed_) {
+    S_inv = nda::matrix<double>(n_delayed, n_delayed);
+    for (auto *v : {&s_col, &s_row, &s_col_2, &s_row_2, &p, &q}) *v = nda::vector<double>(n_delayed);
+    reserve(16);
+  }
+
+  //--------------------------------------------------
+
+  void delayed_det_t::reserve(long n) {
+    if (u_b.size() >= n) return;
+    long cap = 2 * u_b.size();
+    while (cap < n) cap = std::max(2 * cap, 16l);
+    for (auto *v : {&u_b, &v_b, &Mu}) *v = nda::vector<double>(cap);
+  }
+
+  //--------------------------------------------------
+
+  void delayed_det_t::resize_base() {
+    long N = N_base();
+    M_data.resize(N * N);
+    MU_data.resize(N * n_delayed);
+    VM_data.resize(n_delayed * N);
+  }
+
+  //--------------------------------------------------
+
+  double delayed_det_t::insertion_border(op_t const &x, op_t const &y, double *s_c, double *s_r) {
+    long N = long(x_base.size());
+    reserve(N);
+
+    // New column u = (Delta(x_a, y), u_p) and row v = (Delta(x, y_b), v_p) of E. Zero entries on the removal borders.
+    auto u = u_b(range(N)), v = v_b(range(N)), Mu_N = Mu(range(N));
+    f.fill_col(N, [this](long a) { return x_base[a]; }, y, u.data());
+    f.fill_row(x, N, [this](long b) { return y_base[b]; }, v.data());
+
+    // Mu = M u_b. Delta(x, y) - v_b^T M u_b
+    if (N > 0) nda::blas::gemv(1.0, M(), u, 0.0, Mu_N);
+    double s = f(x, y);
+    for (long b = 0; b < N; ++b) s -= v[b] * Mu_N[b];
+
+    // New column u_p - VM u_b and row v_p - v_b^T MU of S
+    auto MU_N = MU(), VM_N = VM();
+    for (long k = 0; k < m; ++k) {
+      double sc = (pending_is_insert[k] ? f(x_pending[k], y) : 0.0);
+      double sr = (pending_is_insert[k] ? f(x, y_pending[k]) : 0.0);
+      for (long a = 0; a < N; ++a) sc -= VM_N(k, a) * u[a];
+      for (long b = 0; b < N; ++b) sr -= v[b] * MU_N(b, k);
+      s_c[k] = sc;
+      s_r[k] = sr;
+    }
+    return s;
+  }
+
+  //--------------------------------------------------
+
+  double delayed_det_t::removal_border(long row, long col, double *s_c, double *s_r) const {
+    // The unit column on the row of x and the unit row on the column of y
+    long N    = long(x_base.size());
+    auto MU_N = MU(), VM_N = VM();
+    for (long k = 0; k < m; ++k) {
+      s_c[k] = (row < N ? -VM_N(k, row) : (row - N == k ? 1.0 : 0.0));
+      s_r[k] = (col < N ? -MU_N(col, k) : (col - N == k ? 1.0 : 0.0));
+    }
+    return (row < N and col < N) ? -M_data[col * N + row] : 0.0;
+  }
+
+  //--------------------------------------------------
+
+  double delayed_det_t::pending_product(double const *s_r, double const *s_c) const {
+    double res = 0;
+    for (long k = 0; k < m; ++k)
+      for (long l = 0; l < m; ++l) res += s_r[k] * S_inv(k, l) * s_c[l];
+    return res;
+  }
+
+  //--------------------------------------------------
+
+  double delayed_det_t::try_insert(long i, long j, op_t const &x, op_t const &y) {
+    last_try = try_kind::insert;
+    try_i = i, try_j = j, try_x = x, try_y = y;
+
+    // Schur complement of the new border
+    try_xi = insertion_border(x, y, s_col.data(), s_row.data());
+    try_xi -= pending_product(s_row.data(), s_col.data());
+
+    // Sign of the insertion at position (i, j) of the ordered matrix
+    try_ratio = ((i + j) % 2 == 0 ? try_xi : -try_xi);
+    if (is_singular(det * try_ratio)) return 0;
+    return try_ratio;
+  }
+
+  //--------------------------------------------------
+
+  double delayed_det_t::try_remove(long i, long j) {
+    last_try = try_kind::remove;
+    try_i = i, try_j = j, try_row = x_row[i], try_col = y_col[j];
+
+    try_xi = removal_border(try_row, try_col, s_col.data(), s_row.data());
+    try_xi -= pending_product(s_row.data(), s_col.data());
+
+    // The border gives -(A^{-1})_{yx}, and the sign of the removal at position (i, j) of the ordered matrix
+    try_ratio = ((i + j) % 2 == 0 ? -try_xi : try_xi);
+    if (is_singular(det * try_ratio)) return 0;
+    return try_ratio;
+  }
+
+  //--------------------------------------------------
+
+  double delayed_det_t::try_change_col_row(long i, long j, op_t const &x, op_t const &y) {
+    long N   = long(x_base.size());
+    last_try = try_kind::change;
+    try_i = i, try_j = j, try_x = x, try_y = y;
+    long row = x_row[i], col = y_col[j];
+
+    // Removal border r of (x_i, y_j) and insertion border n of (x, y), and their 2 x 2 Schur complement X.
+    // The entries of E between the two borders are 0, so X_rn and X_nr only have the - V M U part.
+    double X_rr = removal_border(row, col, s_col.data(), s_row.data());
+    double X_nn = insertion_border(x, y, s_col_2.data(), s_row_2.data());
+    double X_rn = (col < N ? -Mu[col] : 0.0);
+    double X_nr = 0;
+    if (row < N)
+      for (long b = 0; b < N; ++b) X_nr -= v_b[b] * M_data[b * N + row];
+    X_rr -= pending_product(s_row.data(), s_col.data());
+    X_rn -= pending_product(s_row.data(), s_col_2.data());
+    X_nr -= pending_product(s_row_2.data(), s_col.data());
+    X_nn -= pending_product(s_row_2.data(), s_col_2.data());
+
+    // A removal and an insertion at the same position (i, j): their signs cancel, up to the -1 of the removal
+    try_ratio = -(X_rr * X_nn - X_rn * X_nr);
+    if (is_singular(det * try_ratio)) return 0;
+    return try_ratio;
+  }
+
+  //--------------------------------------------------
+
+  double delayed_det_t::try_refill(std::vector<op_t> const &x, std::vector<op_t> const &y) {
+    last_try = try_kind::refill;
+    refill_x = x, refill_y = y;
+    long N         = long(x.size());
+    double new_det = 1;
+    if (N > 0) {
+      auto A = nda::matrix<double>(N, N);
+      for (long a = 0; a < N; ++a)
+        for (long b = 0; b < N; ++b) A(a, b) = f(x[a], y[b]);
+      new_det = nda::determinant(A);
+    }
+    try_ratio = new_det / det;
+    if (is_singular(new_det)) return 0;
+    return try_ratio;
+  }
+
+  //--------------------------------------------------
+
+  void delayed_det_t::complete_operation() {
+    if (last_try == try_kind::none) return;
+
+    // A refill starts a new base, without pending updates
+    if (last_try == try_kind::refill) {
+      long n = long(refill_x.size());
+      x_base = x_cur = std::move(refill_x);
+      y_base = y_cur = std::move(refill_y);
+      x_row.resize(n);
+      y_col.resize(n);
+      for (long i = 0; i < n; ++i) x_row[i] = y_col[i] = i;
+      m = 0;
+      x_pending.clear();
+      y_pending.clear();
+      pending_is_insert.clear();
+      resize_base();
+      regenerate();
+      last_try = try_kind::none;
+      return;
+    }
+
+    // A change is applied to M at once, after the pending updates, as a rank-2 update
+    if (last_try == try_kind::change) {
+      apply_pending();
+      long N = long(x_base.size());
+      change.try_change(
+         f, M_data.data(), N, N, [this](long a) { return x_base[a]; }, [this](long b) { return y_base[b]; }, try_i,
+         try_j, try_x, try_y);
+      change.complete(M_data.data(), N, N, try_i, try_j);
+      x_base[try_i] = x_cur[try_i] = try_x;
+      y_base[try_j] = y_cur[try_j] = try_y;
+      det *= try_ratio;
+      last_try = try_kind::none;
+      if (++n_operations_since_check >= n_operations_before_check) check_precision();
+      return;
+    }
+
+    long N = long(x_base.size());
+
+    // New column of MU (M u_b) and row of VM (v_b^T M) of the border
+    if (N > 0) {
+      auto M_N = M(), MU_N = MU(), VM_N = VM();
+      if (last_try == try_kind::insert) {
+        MU_N(range::all, m) = Mu(range(N));
+        nda::blas::gemv(1.0, nda::transpose(M_N), v_b(range(N)), 0.0, VM_N(m, range::all));
+      } else {
+        if (try_row < N)
+          MU_N(range::all, m) = M_N(range::all, try_row);
+        else
+          MU_N(range::all, m) = 0;
+        if (try_col < N)
+          VM_N(m, range::all) = M_N(try_col, range::all);
+        else
+          VM_N(m, range::all) = 0;
+      }
+    }
+
+    // Bordered inverse of S: with p = S^{-1} s_col, q = s_row^T S^{-1},
+    // S'^{-1} = [[S^{-1} + p q^T / xi, -p / xi], [-q^T / xi, 1 / xi]]
+    for (long k = 0; k < m; ++k) {
+      p[k] = 0, q[k] = 0;
+      for (long l = 0; l < m; ++l) {
+        p[k] += S_inv(k, l) * s_col[l];
+        q[k] += s_row[l] * S_inv(l, k);
+      }
+    }
+    for (long k = 0; k < m; ++k) {
+      for (long l = 0; l < m; ++l) S_inv(k, l) += p[k] * q[l] / try_xi;
+      S_inv(k, m) = -p[k] / try_xi;
+      S_inv(m, k) = -q[k] / try_xi;
+    }
+    S_inv(m, m) = 1 / try_xi;
+
+    // Update the current configuration
+    if (last_try == try_kind::insert) {
+      x_pending.push_back(try_x);
+      y_pending.push_back(try_y);
+      pending_is_insert.push_back(true);
+      x_cur.insert(x_cur.begin() + try_i, try_x);
+      y_cur.insert(y_cur.begin() + try_j, try_y);
+      x_row.insert(x_row.begin() + try_i, N + m);
+      y_col.insert(y_col.begin() + try_j, N + m);
+    } else {
+      x_pending.emplace_back();
+      y_pending.emplace_back();
+      pending_is_insert.push_back(false);
+      x_cur.erase(x_cur.begin() + try_i);
+      y_cur.erase(y_cur.begin() + try_j);
+      x_row.erase(x_row.begin() + try_i);
+      y_col.erase(y_col.begin() + try_j);
+    }
+    ++m;
+    det *= try_ratio;
+    ++n_operations_since_check;
+    last_try = try_kind::none;
+
+    if (m == n_delayed) flush();
+  }
+
+  //--------------------------------------------------
+
+  void delayed_det_t::flush() {
+    long N = long(x_base.size());
+
+    // E^{-1} = [[M + T VM, -T], [-W, S^{-1}]], with T = MU S^{-1} (N x m) and W = S^{-1} VM (m x N).
+    // The rank-m update is done in place on M, the other blocks are read from T, W and S^{-1} in the gather.
+    auto S_inv_m = S_inv(range(m), range(m));
+    T_data.resize(N * m);
+    W_data.resize(m * N);
+    if (N > 0) {
+      auto VM_m = VM()(range(m), range::all);
+      auto T    = nda::matrix_view<double>{std::array{N, m}, T_data.data()};
+      auto W    = nda::matrix_view<double>{std::array{m, N}, W_data.data()};
+      nda::blas::gemm(1.0, MU()(range::all, range(m)), S_inv_m, 0.0, T);
+      nda::blas::gemm(1.0, T, VM_m, 1.0, M());
+      nda::blas::gemm(1.0, S_inv_m, VM_m, 0.0, W);
+    }
+
+    // The inverse of the current configuration is the new base: rows of the y (columns of E), columns of the x
+    long n_cur = size();
+    M_new_data.resize(n_cur * n_cur);
+    for (long j = 0; j < n_cur; ++j) {
+      long r     = y_col[j];
+      double *to = M_new_data.data() + j * n_cur;
+      if (r < N) {
+        double const *M_r = M_data.data() + r * N, *T_r = T_data.data() + r * m;
+        for (long i = 0; i < n_cur; ++i) to[i] = (x_row[i] < N ? M_r[x_row[i]] : -T_r[x_row[i] - N]);
+      } else {
+        double const *W_r = W_data.data() + (r - N) * N;
+        for (long i = 0; i < n_cur; ++i) to[i] = (x_row[i] < N ? -W_r[x_row[i]] : S_inv(r - N, x_row[i] - N));
+      }
+    }
+    std::swap(M_data, M_new_data);
+    x_base = x_cur;
+    y_base = y_cur;
+    for (long i = 0; i < n_cur; ++i) x_row[i] = y_col[i] = i;
+    resize_base();
+
+    m = 0;
+    x_pending.clear();
+    y_pending.clear();
+    pending_is_insert.clear();
+
+    if (n_operations_since_check >= n_operations_before_check) check_precision();
+  }
+
+  //--------------------------------------------------
+
+  double delayed_det_t::regenerate() {
+    apply_pending();
+    long N = long(x_base.size());
+    det    = 1;
+    if (N == 0) return 0;
+    auto A = nda::matrix<double>(N, N);
+    for (long a = 0; a < N; ++a)
+      for (long b = 0; b < N; ++b) A(a, b) = f(x_base[a], y_base[b]);
+    det        = nda::determinant(A);
+    auto M_new = nda::inverse(A);
+    double err = nda::max_element(nda::abs(M_new - M()));
+    M()        = M_new;
+    return err;
+  }
+
+  void delayed_det_t::check_precision() {
+    n_operations_since_check = 0;
+    double err               = regenerate();
+    if (err > precision_warning) spdlog::info("WARNING: delayed det: deviation of the inverse matrix {}", err);
+    ALWAYS_EXPECTS((err <= precision_error), "Error: delayed det: deviation of the inverse matrix {}", err);
+  }
+
+  //--------------------------------------------------
+
+  namespace {
+    // Inverse of the n x n matrix A (row major) by Gauss-Jordan elimination with partial pivoting.
+    // A is destroyed, the inverse is written in inv. Returns the determinant of A, or 0 (and no inverse) if a pivot
+    // is zero.
+    double gauss_jordan_inverse(std::vector<double> &A, std::vector<double> &inv, long n) {
+      inv.assign(n * n, 0.0);
+      for (long k = 0; k < n; ++k) inv[k * n + k] = 1;
+      double det = 1;
+      for (long c = 0; c < n; ++c) {
+        long p = c;
+        for (long r = c + 1; r < n; ++r)
+          if (std::abs(A[r * n + c]) > std::abs(A[p * n + c])) p = r;
+        if (p != c) {
+          det = -det;
+          for (long k = 0; k < n; ++k) {
+            std::swap(A[p * n + k], A[c * n + k]);
+            std::swap(inv[p * n + k], inv[c * n + k]);
+          }
+        }
+        double pivot = A[c * n + c];
+        if (pivot == 0) return 0;
+        det *= pivot;
+        for (long k = 0; k < n; ++k) {
+          A[c * n + k] /= pivot;
+          inv[c * n + k] /= pivot;
+        }
+        for (long r = 0; r < n; ++r) {
+          if (r == c) continue;
+          double factor = A[r * n + c];
+          if (factor == 0) continue;
+          for (long k = 0; k < n; ++k) {
+            A[r * n + k] -= factor * A[c * n + k];
+            inv[r * n + k] -= factor * inv[c * n + k];
+          }
+        }
+      }
+      return det;
+    }
+  } // namespace
+
+  small_det_t::small_det_t(Delta_block_adaptor f_) : f(std::move(f_)) {
+    for (auto *v : {&B, &C, &MB, &CM}) v->reserve(n_inline);
+    x.reserve(n_inline);
+    y.reserve(n_inline);
+  }
+
+  //--------------------------------------------------
+
+  void small_det_t::reserve(long n) {
+    if (n <= ld) return;
+    long new_ld = 2 * ld;
+    while (new_ld < n) new_ld *= 2;
+    std::vector<double> new_M(new_ld * new_ld);
+    double const *old_M = M_data();
+    for (long b = 0; b < N; ++b)
+      for (long a = 0; a < N; ++a) new_M[b * new_ld + a] = old_M[b * ld + a];
+    M_heap = std::move(new_M);
+    ld     = new_ld;
+  }
+
+  //--------------------------------------------------
+
+  double small_det_t::try_insert(long i, long j, op_t const &x_, op_t const &y_) {
+    last_try = try_kind::insert;
+    try_i = i, try_j = j, try_x = x_, try_y = y_;
+
+    // B = Delta(x_a, y), C = Delta(x, y_b), MB = M B, xi = Delta(x, y) - C M B
+    B.resize(N);
+    C.resize(N);
+    MB.resize(N);
+    f.fill_col(N, [this](long a) { return x[a]; }, y_, B.data());
+    f.fill_row(x_, N, [this](long b) { return y[b]; }, C.data());
+    double const *M = M_data();
+    try_xi          = f(x_, y_);
+    for (long b = 0; b < N; ++b) {
+      double r = 0;
+      for (long a = 0; a < N; ++a) r += M[b * ld + a] * B[a];
+      MB[b] = r;
+      try_xi -= C[b] * r;
+    }
+    try_ratio = ((i + j) % 2 == 0 ? try_xi : -try_xi);
+    if (is_singular(det * try_ratio)) return 0;
+    return try_ratio;
+  }
+
+  //--------------------------------------------------
+
+  double small_det_t::try_remove(long i, long j) {
+    last_try = try_kind::remove;
+    try_i = i, try_j = j;
+    try_xi    = M_data()[j * ld + i];
+    try_ratio = ((i + j) % 2 == 0 ? try_xi : -try_xi);
+    if (is_singular(det * try_ratio)) return 0;
+    return try_ratio;
+  }
+
+  //--------------------------------------------------
+
+  double small_det_t::try_change_col_row(long i, long j, op_t const &x_, op_t const &y_) {
+    last_try = try_kind::change;
+    try_i = i, try_j = j, try_x = x_, try_y = y_;
+    try_ratio = change.try_change(
+       f, M_data(), ld, N, [this](long a) { return x[a]; }, [this](long b) { return y[b]; }, i, j, x_, y_);
+    if (is_singular(det * try_ratio)) return 0;
+    return try_ratio;
+  }
+
+  //--------------------------------------------------
+
+  double small_det_t::try_refill(std::vector<op_t> const &x_, std::vector<op_t> const &y_) {
+    last_try = try_kind::refill;
+    refill_x = x_, refill_y = y_;
+    long n = long(x_.size());
+    std::vector<double> A(n * n), inv;
+    for (long a = 0; a < n; ++a)
+      for (long b = 0; b < n; ++b) A[a * n + b] = f(x_[a], y_[b]);
+    double new_det = (n == 0 ? 1.0 : gauss_jordan_inverse(A, inv, n));
+    try_ratio      = new_det / det;
+    if (is_singular(new_det)) return 0;
+    return try_ratio;
+  }
+
+  //--------------------------------------------------
+
+  void small_det_t::complete_operation() {
+    if (last_try == try_kind::none) return;
+
+    // M is computed from scratch for the new x and y
+    if (last_try == try_kind::refill) {
+      reserve(long(refill_x.size()));
+      x = std::move(refill_x);
+      y = std::move(refill_y);
+      N = long(x.size());
+      regenerate();
+      last_try = try_kind::none;
+      return;
+    }
+
+    long i = try_i, j = try_j;
+
+    if (last_try == try_kind::change) {
+      change.complete(M_data(), ld, N, i, j);
+      x[i] = try_x;
+      y[j] = try_y;
+    } else if (last_try == try_kind::insert) {
+      reserve(N + 1);
+      double *M = M_data();
+      // CM = C M
+      CM.assign(N, 0.0);
+      for (long b = 0; b < N; ++b)
+        for (long a = 0; a < N; ++a) CM[a] += C[b] * M[b * ld + a];
+      // M + MB CM / xi, moved in place to the rows b >= j and columns a >= i shifted by one.
+      // Targets are after their sources in memory, so going backward does not overwrite unread elements.
+      for (long b = N - 1; b >= 0; --b) {
+        long rb = (b < j ? b : b + 1);
+        for (long a = N - 1; a >= 0; --a) M[rb * ld + (a < i ? a : a + 1)] = M[b * ld + a] + MB[b] * CM[a] / try_xi;
+      }
+      // New row j and column i
+      for (long a = 0; a < N; ++a) M[j * ld + (a < i ? a : a + 1)] = -CM[a] / try_xi;
+      for (long b = 0; b < N; ++b) M[(b < j ? b : b + 1) * ld + i] = -MB[b] / try_xi;
+      M[j * ld + i] = 1 / try_xi;
+      x.insert(x.begin() + i, try_x);
+      y.insert(y.begin() + j, try_y);
+      ++N;
+    } else {
+      double *M = M_data();
+      // Copy column i and row j, which are overwritten by the compaction
+      MB.resize(N);
+      CM.resize(N);
+      for (long b = 0; b < N; ++b) MB[b] = M[b * ld + i];
+      for (long a = 0; a < N; ++a) CM[a] = M[j * ld + a];
+      // M - M(:, i) M(j, :) / M(j, i) without row j and column i, moved forward in place
+      for (long b = 0; b < N; ++b) {
+        if (b == j) continue;
+        long rb = (b < j ? b : b - 1);
+        for (long a = 0; a < N; ++a) {
+          if (a == i) continue;
+          M[rb * ld + (a < i ? a : a - 1)] = M[b * ld + a] - MB[b] * CM[a] / try_xi;
+        }
+      }
+      x.erase(x.begin() + i);
+      y.erase(y.begin() + j);
+      --N;
+    }
+    det *= try_ratio;
+    last_try = try_kind::none;
+    if (++n_operations_since_check >= n_operations_before_check) check_precision();
+  }
+
+  //--------------------------------------------------
+
+  double small_det_t::regenerate() {
+    std::vector<double> A(N * N), inv;
+    for (long a = 0; a < N; ++a)
+      for (long b = 0; b < N; ++b) A[a * N + b] = f(x[a], y[b]);
+    det = (N == 0 ? 1.0 : gauss_jordan_inverse(A, inv, N));
+    if (det == 0) {
+      // Zero pivot: fall back to the LU factorization, as det_manip
+      auto A_lu = nda::matrix<double>(N, N);
+      for (long a = 0; a < N; ++a)
+        for (long b = 0; b < N; ++b) A_lu(a, b) = f(x[a], y[b]);
+      det = nda::determinant(A_lu);
+      ALWAYS_EXPECTS((det != 0), "Error: small det: the matrix is singular");
+      auto inv_lu = nda::inverse(A_lu);
+      inv.assign(inv_lu.data(), inv_lu.data() + N * N);
+    }
+    double *M  = M_data();
+    double err = 0;
+    for (long b = 0; b < N; ++b)
+      for (long a = 0; a < N; ++a) {
+        err           = std::max(err, std::abs(inv[b * N + a] - M[b * ld + a]));
+        M[b * ld + a] = inv[b * N + a];
+      }
+    return err;
+  }
+
+  void small_det_t::check_precision() {
+    n_operations_since_check = 0;
+    double err               = regenerate();
+    if (err > precision_warning) spdlog::info("WARNING: small det: deviation of the inverse matrix {}", err);
+    ALWAYS_EXPECTS((err <= precision_error), "Error: small det: deviation of the inverse matrix {}", err);
+  }
+
+  //--------------------------------------------------
+
+  double regenerate(det_manip_t &D) {
+    long N = D.size();
+    if (N == 0) return 0;
+    // The updated inverse, compared to the one of the regeneration (a single inversion)
+    auto M_old = D.inverse_matrix();
+    D.regenerate();
+    double err = 0;
+    for (long j = 0; j < N; ++j)
+      for (long i = 0; i < N; ++i) err = std::max(err, std::abs(M_old(j, i) - D.inverse_matrix(j, i)));
+    return err;
+  }
+
+  //--------------------------------------------------
+
+  nda::matrix_const_view<double> det_t::inverse_matrix() const {
+    // The delayed det keeps M in time order, the others are copied in inverse_buffer
+    if (auto *d = std::get_if<delayed_det_t>(&impl)) {
+      d->apply_pending();
+      return d->inverse_matrix();
+    }
+    if (auto *d = std::get_if<det_manip_t>(&impl)) {
+      inverse_buffer = d->inverse_matrix();
+      return inverse_buffer;
+    }
+    auto const &d = std::get<small_det_t>(impl);
+    long N        = d.size();
+    inverse_buffer.resize(N, N);
+    for (long j = 0; j < N; ++j)
+      for (long i = 0; i < N; ++i) inverse_buffer(j, i) = d.inverse_matrix(j, i);
+    return inverse_buffer;
+  }
+
+  //--------------------------------------------------
+
+  void det_t::rebuild(bool small) {
+    long N = size();
+    std::vector<std::pair<tau_t, int>> x(N), y(N);
+    for (long i = 0; i < N; ++i) x[i] = get_x(i);
+    for (long j = 0; j < N; ++j) y[j] = get_y(j);
+    auto f = visit([](auto const &d) { return Delta_block_adaptor{d.get_function()}; });
+    impl   = make(std::move(f), init_size, n_delayed, small);
+    // With an adaptive check, the checks are done here, not in the det
+    long n_before_check = (adaptive_check ? std::numeric_limits<int>::max() : n_operations_before_check);
+    visit([&](auto &d) {
+      d.set_n_operations_before_check(n_before_check);
+      d.set_precision_warning(precision_warning);
+      d.set_precision_error(precision_error);
+      d.set_singular_threshold(singular_threshold);
+      if (N > 0) {
+        d.try_refill(x, y);
+        d.complete_operation();
+      }
+    });
+  }
+
+  //--------------------------------------------------
+
+  void det_t::enable_adaptive_check(long initial_interval) {
+    adaptive_check = true;
+    check_interval = std::max(initial_interval, 1l);
+    // The checks are done here, not in the det
+    visit([](auto &d) { d.set_n_operations_before_check(std::numeric_limits<int>::max()); });
+  }
+
+  void det_t::adaptive_check_step() {
+    n_operations_since_check = 0;
+    double drift             = visit([](auto &d) {
+      if constexpr (std::is_same_v<std::decay_t<decltype(d)>, det_manip_t>)
+        return regenerate(d);
+      else
+        return d.regenerate();
+    });
+    ++n_checks;
+    max_drift = std::max(max_drift, drift);
+    if (drift > precision_warning) spdlog::info("WARNING: det: deviation of the inverse matrix {}", drift);
+    ALWAYS_EXPECTS((drift <= precision_error), "Error: det: deviation of the inverse matrix {}", drift);
+    // Keep the deviation between precision_warning / 4 and precision_warning / 2
+    if (drift < precision_warning / 4)
+      check_interval = std::min(2 * check_interval, max_check_interval);
+    else if (drift > precision_warning / 2)
+      check_interval = std::max(check_interval / 2, 1l);
+  }
+
+} // namespace triqs_ctseg
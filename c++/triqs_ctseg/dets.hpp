@@ -16,27 +16,527 @@
 // Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
 
 #pragma once
+#include <array>
+#include <variant>
+#include <vector>
 #include <triqs/gfs.hpp>
 #include <triqs/det_manip.hpp>
 
 #include "./tau_t.hpp"
+#include "./interpolation.hpp"
+#include "./Delta_poles.hpp"
 
 using namespace triqs::gfs;
 using namespace triqs::mesh;
 
 namespace triqs_ctseg {
 
-  /// A lambda to adapt Delta(tau) for the call by det_manip.
+  /**
+   * A lambda to adapt Delta(tau) for the call by det_manip.
+   *
+   * Delta(tau) of the block is tabulated once on its tau mesh (see interp_table_t), and evaluated by linear
+   * interpolation directly from the tau_t difference. This avoids the generic gf evaluator (mesh lookup,
+   * construction of the matrix of the block and extraction of one element) for each matrix element.
+   * Alternatively, Delta(tau) is given by a pole representation (see Delta_poles.hpp), and the table is not built.
+   */
   struct Delta_block_adaptor {
-    gf<imtime, matrix_real_valued> Delta;
+    interp_table_t Delta; // Delta_ab(tau) is the function a * block_size + b of the table
+    Delta_poles_t poles;  // Delta_ab(tau) in the pole representation, if use_poles
+    bool use_poles  = false;
+    long block_size = 1; // Size of the block
+
+    Delta_block_adaptor(gf_const_view<imtime, matrix_real_valued> D) : Delta(D), block_size(D.target_shape()[1]) {}
+
+    Delta_block_adaptor(Delta_poles_t p, long block_size_)
+       : poles(std::move(p)), use_poles(true), block_size(block_size_) {}
+
+    // Delta_k(tau), k = a * block_size + b
+    double value(long k, tau_t const &tau) const { return use_poles ? poles(k, tau) : Delta(k, tau); }
 
     double operator()(std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y) const {
-      double res = Delta(double(x.first - y.first))(x.second, y.second);
+      double res = value(x.second * block_size + y.second, x.first - y.first);
       return (x.first >= y.first ? res : -res); // x,y first are tau_t, wrapping is automatic in
                                                 // the - operation, but need to compute the sign
     }
+
+    // Batched evaluation of a row of the matrix: res[n] = Delta(x, y(n)) for n = 0, ..., N - 1,
+    // where y(n) returns the n-th y (e.g. [&D](long n) { return D.get_y(n); }).
+    // Used by the dets which build their rows and columns themselves (col_row_change_t, delayed_det_t, small_det_t):
+    // det_manip calls operator() element by element.
+    void fill_row(std::pair<tau_t, int> const &x, long N, auto const &y, double *res) const {
+      long k0 = x.second * block_size;
+      for (long n = 0; n < N; ++n) {
+        auto const &yn = y(n);
+        double r       = value(k0 + yn.second, x.first - yn.first);
+        res[n]         = (x.first >= yn.first ? r : -r);
+      }
+    }
+
+    // Batched evaluation of a column of the matrix: res[n] = Delta(x(n), y) for n = 0, ..., N - 1.
+    void fill_col(long N, auto const &x, std::pair<tau_t, int> const &y, double *res) const {
+      for (long n = 0; n < N; ++n) {
+        auto const &xn = x(n);
+        double r       = value(xn.second * block_size + y.second, xn.first - y.first);
+        res[n]         = (xn.first >= y.first ? r : -r);
+      }
+    }
+  };
+
+  using det_manip_t = triqs::det_manip::det_manip<Delta_block_adaptor>;
+
+  /**
+   * Connected components of a block of Delta(tau).
+   *
+   * Two indices a, b of the block are connected if |Delta_ab(tau)| or |Delta_ba(tau)| is above tolerance for some tau.
+   * If Delta(tau) is block-diagonal up to a permutation of the indices, its det is (up to a sign) the product of the
+   * dets of the components. Returns the indices of each component, in increasing order, with the components ordered
+   * by their first index.
+   */
+  std::vector<std::vector<long>> Delta_block_components(gf_const_view<imtime, matrix_real_valued> D,
+                                                        double tolerance);
+
+  /**
+   * Change of the row i (x_i -> x') and the column j (y_j -> y') of A, A(a, b) = Delta(x_a, y_b), as a rank-2 update
+   * of its inverse M, stored as M(b, a) = M[b * ld + a].
+   *
+   * A' = A + e_i u^T + v e_j^T, with u_b = Delta(x', y_b) - A(i, b) (u_j = 0) and v_a = Delta(x_a, y') - A(a, j)
+   * (v_i = Delta(x', y') - A(i, j)). By the Woodbury identity, det A' / det A = det K, with
+   * K = I + [u, e_j]^T M [e_i, v], and M' = M - M [e_i, v] K^{-1} [u, e_j]^T M. O(N^2), as a rank-1 update.
+   */
+  struct col_row_change_t {
+    std::vector<double> u, v, q, r; // q = M v, r = u^T M
+    double K_inv[2][2] = {};
+
+    // Ratio det A' / det A. x(a) and y(b) return the a-th x and b-th y.
+    double try_change(Delta_block_adaptor const &f, double const *M, long ld, long N, auto const &x, auto const &y,
+                      long i, long j, std::pair<tau_t, int> const &x_new, std::pair<tau_t, int> const &y_new) {
+      u.resize(N), v.resize(N), q.resize(N), r.resize(N);
+      // New row and column, minus the old ones (in r and q)
+      f.fill_row(x_new, N, y, u.data());
+      f.fill_row(x(i), N, y, r.data());
+      f.fill_col(N, x, y_new, v.data());
+      f.fill_col(N, x, y(j), q.data());
+      for (long b = 0; b < N; ++b) u[b] -= r[b];
+      for (long a = 0; a < N; ++a) v[a] -= q[a];
+      u[j] = 0;
+      v[i] = f(x_new, y_new) - q[i];
+      // q = M v, r = u^T M
+      for (long b = 0; b < N; ++b) {
+        double s = 0;
+        for (long a = 0; a < N; ++a) s += M[b * ld + a] * v[a];
+        q[b] = s;
+      }
+      for (long a = 0; a < N; ++a) r[a] = 0;
+      for (long b = 0; b < N; ++b)
+        for (long a = 0; a < N; ++a) r[a] += u[b] * M[b * ld + a];
+      double K00 = 1 + r[i], K11 = 1 + q[j], K10 = M[j * ld + i], K01 = 0;
+      for (long b = 0; b < N; ++b) K01 += u[b] * q[b];
+      double det_K = K00 * K11 - K01 * K10;
+      K_inv[0][0] = K11 / det_K, K_inv[0][1] = -K01 / det_K;
+      K_inv[1][0] = -K10 / det_K, K_inv[1][1] = K00 / det_K;
+      return det_K;
+    }
+
+    // Update M in place, after try_change
+    void complete(double *M, long ld, long N, long i, long j) {
+      // Column i and row j of M, in u and v (no longer used)
+      for (long b = 0; b < N; ++b) u[b] = M[b * ld + i];
+      for (long a = 0; a < N; ++a) v[a] = M[j * ld + a];
+      for (long b = 0; b < N; ++b) {
+        double p0 = u[b] * K_inv[0][0] + q[b] * K_inv[1][0];
+        double p1 = u[b] * K_inv[0][1] + q[b] * K_inv[1][1];
+        for (long a = 0; a < N; ++a) M[b * ld + a] -= p0 * r[a] + p1 * v[a];
+      }
+    }
+  };
+
+  /**
+   * Determinant of Delta with delayed updates of its inverse.
+   *
+   * Same interface as det_manip for the operations used by the moves and measures. Instead of a rank-1 update of
+   * the inverse at each accepted insertion or removal, the accepted changes are kept as a border of the matrix of
+   * the last updated configuration (the base, of size N, with inverse M):
+   *
+   *   E = [[A, U], [V, W]]
+   *
+   * An inserted (x, y) adds the column $\Delta(x_a, y)$ and the row $\Delta(x, y_b)$. A removed (x, y) adds the
+   * column $e_x$ and the row $e_y$ (unit vectors on the row of x and the column of y of E), which decouple them from
+   * the other operators. The inverse of the current matrix is then a block of
+   *
+   *   E^{-1} = [[M + MU S^{-1} VM, -MU S^{-1}], [-S^{-1} VM, S^{-1}]],    S = W - V M U
+   *
+   * and the ratio of a try is the Schur complement of one more border, computed exactly from M, MU, VM and
+   * $S^{-1}$ in O(N^2 + N k) for k pending updates (one matrix-vector product with M, as in det_manip). After
+   * n_delayed accepted updates, or before the inverse is read (e.g. by a measure), the pending updates are applied
+   * at once, with a rank-k (matrix-matrix) update of M.
+   *
+   * A change of the row i and the column j is a removal followed by an insertion at the same position, i.e. two
+   * more borders, and its ratio is the det of their 2 x 2 Schur complement. It is tried with the pending updates;
+   * only an accepted change applies them, before the rank-2 update of M (see col_row_change_t).
+   */
+  class delayed_det_t {
+    public:
+    using op_t = std::pair<tau_t, int>;
+
+    private:
+    Delta_block_adaptor f;
+    long n_delayed; // Maximum number of pending updates
+
+    // Base configuration: x and y in increasing time order, M(b, a) = A^{-1}(b, a), A(a, b) = Delta(x_a, y_b)
+    std::vector<op_t> x_base, y_base;
+    double det = 1; // Determinant of the current configuration
+
+    // Pending updates (borders of E). MU is N x n_delayed, VM is n_delayed x N, S_inv is n_delayed x n_delayed,
+    // filled up to m. For an insertion border, the inserted x and y (for the entries between borders).
+    long m = 0;
+    nda::matrix<double> S_inv;
+    std::vector<op_t> x_pending, y_pending;
+    std::vector<bool> pending_is_insert;
+
+    // Storage of M, MU and VM (row major, for the order N of the base), and of the work matrices of flush: the new M,
+    // T = MU S^{-1} (N x m) and W = S^{-1} VM (m x N). Resized with the order, they only allocate when it exceeds
+    // the largest order so far.
+    std::vector<double> M_data, MU_data, VM_data, M_new_data, T_data, W_data;
+
+    // Views of M, MU and VM on their storage
+    [[nodiscard]] long N_base() const { return long(x_base.size()); }
+    nda::matrix_view<double> M() { return {std::array{N_base(), N_base()}, M_data.data()}; }
+    [[nodiscard]] nda::matrix_const_view<double> M() const { return {std::array{N_base(), N_base()}, M_data.data()}; }
+    nda::matrix_view<double> MU() { return {std::array{N_base(), n_delayed}, MU_data.data()}; }
+    [[nodiscard]] nda::matrix_const_view<double> MU() const {
+      return {std::array{N_base(), n_delayed}, MU_data.data()};
+    }
+    nda::matrix_view<double> VM() { return {std::array{n_delayed, N_base()}, VM_data.data()}; }
+    [[nodiscard]] nda::matrix_const_view<double> VM() const {
+      return {std::array{n_delayed, N_base()}, VM_data.data()};
+    }
+
+    // Resize the storage of M, MU and VM for the order of the base
+    void resize_base();
+
+    // Current configuration, in increasing time order, with the row (column) of E of each x (y)
+    std::vector<op_t> x_cur, y_cur;
+    std::vector<long> x_row, y_col;
+
+    // Last try
+    enum class try_kind { none, insert, remove, change, refill };
+    try_kind last_try = try_kind::none;
+    long try_i = 0, try_j = 0;       // Position of x and y in the current configuration
+    op_t try_x, try_y;               // Inserted operators
+    long try_row = 0, try_col = 0;   // Removed row and column of E
+    double try_xi = 0, try_ratio = 0; // Schur complement of the new border and ratio of the dets
+
+    // Work vectors, allocated once (u_b, v_b, Mu grow with N): the new column u_b and row v_b of an insertion on
+    // the base, Mu = M u_b, the column s_col and row s_row of the new border of S (s_col_2, s_row_2: second border
+    // of a change), p = S^{-1} s_col and q = s_row^T S^{-1}. The first N (or m) elements are used.
+    nda::vector<double> u_b, v_b, Mu, s_col, s_row, s_col_2, s_row_2, p, q;
+    col_row_change_t change; // Accepted change of a row and a column
+    std::vector<op_t> refill_x, refill_y; // Last try of a refill
+
+    // Precision checks
+    long n_operations_before_check = 100, n_operations_since_check = 0;
+    double precision_warning = 1.e-8, precision_error = 1.e-5, singular_threshold = -1;
+
+    // Apply the pending updates and start a new base
+    void flush();
+
+    // Grow u_b, v_b and Mu to hold at least n elements
+    void reserve(long n);
+
+    // Border of the insertion of (x, y): fills u_b, v_b, Mu, and its column and row of S in s_c and s_r.
+    // Returns its diagonal element before the pending borders, Delta(x, y) - v_b^T M u_b.
+    double insertion_border(op_t const &x, op_t const &y, double *s_c, double *s_r);
+
+    // Border of the removal of the row and the column of E: fills its column and row of S in s_c and s_r.
+    // Returns its diagonal element before the pending borders.
+    double removal_border(long row, long col, double *s_c, double *s_r) const;
+
+    // s_r^T S^{-1} s_c over the pending borders
+    [[nodiscard]] double pending_product(double const *s_r, double const *s_c) const;
+
+    // Regenerate, with a warning or an error if the deviation is above the precision thresholds
+    void check_precision();
+
+    // Is the new det singular?
+    [[nodiscard]] bool is_singular(double new_det) const {
+      return (singular_threshold < 0) ? not std::isnormal(std::abs(new_det)) : (std::abs(new_det) < singular_threshold);
+    }
+
+    public:
+    delayed_det_t(Delta_block_adaptor f_, long n_delayed_);
+
+    [[nodiscard]] long size() const { return long(x_cur.size()); }
+    [[nodiscard]] Delta_block_adaptor const &get_function() const { return f; }
+    [[nodiscard]] op_t const &get_x(long i) const { return x_cur[i]; }
+    [[nodiscard]] op_t const &get_y(long j) const { return y_cur[j]; }
+
+    /// Element (j, i) of the inverse of the current matrix. The pending updates must have been applied (see flush).
+    [[nodiscard]] double inverse_matrix(long j, long i) const { return M_data[j * N_base() + i]; }
+
+    /// The inverse of the current matrix. The pending updates must have been applied (see flush).
+    [[nodiscard]] nda::matrix_const_view<double> inverse_matrix() const { return M(); }
+
+    /// Are there pending updates?
+    [[nodiscard]] bool has_pending() const { return m > 0; }
+
+    /// Apply the pending updates, if any
+    void apply_pending() {
+      if (m > 0) flush();
+    }
+
+    /// Apply the pending updates and recompute M and det from scratch. Returns the deviation of the updated M.
+    double regenerate();
+
+    double try_insert(long i, long j, op_t const &x, op_t const &y);
+    double try_remove(long i, long j);
+    // If accepted, the pending updates are applied: the change is a rank-2 update of M, not delayed
+    double try_change_col_row(long i, long j, op_t const &x, op_t const &y);
+    // Replace all the x and y (in increasing time order). O(N^3), the accepted refill starts a new base
+    double try_refill(std::vector<op_t> const &x, std::vector<op_t> const &y);
+    void complete_operation();
+    void reject_last_try() { last_try = try_kind::none; }
+
+    void set_n_operations_before_check(long n) { n_operations_before_check = n; }
+    void set_precision_warning(double p) { precision_warning = p; }
+    void set_precision_error(double p) { precision_error = p; }
+    void set_singular_threshold(double t) { singular_threshold = t; }
+  };
+
+  /**
+   * Determinant of Delta for small orders, with the same interface as det_manip.
+   *
+   * The inverse is kept in time order (no permutation of rows and columns), in a buffer inline in the object up to
+   * n_inline x n_inline, and on the heap beyond. The Sherman-Morrison updates shift the rows and columns in place,
+   * which at small N is cheaper than the dynamic matrices and indirections of det_manip, and still O(N^2) beyond.
+   */
+  class small_det_t {
+    public:
+    using op_t                     = std::pair<tau_t, int>;
+    static constexpr long n_inline = 16;
+
+    private:
+    Delta_block_adaptor f;
+    long N  = 0;        // Size of the matrix
+    long ld = n_inline; // Leading dimension of the storage of M
+    std::array<double, n_inline * n_inline> M_inline;
+    std::vector<double> M_heap; // Storage of M if ld > n_inline
+    std::vector<op_t> x, y;     // In increasing time order
+    double det = 1;
+
+    // Last try
+    enum class try_kind { none, insert, remove, change, refill };
+    try_kind last_try = try_kind::none;
+    long try_i = 0, try_j = 0;
+    op_t try_x, try_y;
+    double try_xi = 0, try_ratio = 0;
+    std::vector<double> B, C, MB, CM; // Work vectors, reserved for n_inline
+    col_row_change_t change;          // Last try of a change of a row and a column
+    std::vector<op_t> refill_x, refill_y; // Last try of a refill
+
+    // Precision checks
+    long n_operations_before_check = 100, n_operations_since_check = 0;
+    double precision_warning = 1.e-8, precision_error = 1.e-5, singular_threshold = -1;
+
+    [[nodiscard]] double *M_data() { return (ld > n_inline) ? M_heap.data() : M_inline.data(); }
+    [[nodiscard]] double const *M_data() const { return (ld > n_inline) ? M_heap.data() : M_inline.data(); }
+
+    // Grow the storage to hold a matrix of size n
+    void reserve(long n);
+
+    // Regenerate, with a warning or an error if the deviation is above the precision thresholds
+    void check_precision();
+
+    [[nodiscard]] bool is_singular(double new_det) const {
+      return (singular_threshold < 0) ? not std::isnormal(std::abs(new_det)) : (std::abs(new_det) < singular_threshold);
+    }
+
+    public:
+    explicit small_det_t(Delta_block_adaptor f_);
+
+    [[nodiscard]] long size() const { return N; }
+    [[nodiscard]] Delta_block_adaptor const &get_function() const { return f; }
+    [[nodiscard]] op_t const &get_x(long i) const { return x[i]; }
+    [[nodiscard]] op_t const &get_y(long j) const { return y[j]; }
+
+    /// Element (j, i) of the inverse matrix
+    [[nodiscard]] double inverse_matrix(long j, long i) const { return M_data()[j * ld + i]; }
+
+    /// Recompute M and det from scratch. Returns the deviation of the updated M.
+    double regenerate();
+
+    double try_insert(long i, long j, op_t const &x_, op_t const &y_);
+    double try_remove(long i, long j);
+    double try_change_col_row(long i, long j, op_t const &x_, op_t const &y_);
+    // Replace all the x and y (in increasing time order). O(N^3)
+    double try_refill(std::vector<op_t> const &x_, std::vector<op_t> const &y_);
+    void complete_operation();
+    void reject_last_try() { last_try = try_kind::none; }
+
+    void set_n_operations_before_check(long n) { n_operations_before_check = n; }
+    void set_precision_warning(double p) { precision_warning = p; }
+    void set_precision_error(double p) { precision_error = p; }
+    void set_singular_threshold(double t) { singular_threshold = t; }
   };
 
-  using det_t = triqs::det_manip::det_manip<Delta_block_adaptor>;
+  // Recompute the inverse of a det_manip from scratch. Returns the deviation of the updated inverse.
+  double regenerate(det_manip_t &D);
+
+  /**
+   * The det of a block: a det_manip (immediate rank-1 updates), a delayed_det_t (if n_delayed_updates > 0)
+   * or a small_det_t, with the same interface.
+   *
+   * The small_det_t is used while the order of the det is at most small_max_order (0: never). Above, the det is
+   * rebuilt (in O(N^3)) as a det_manip or a delayed_det_t, and it goes back to a small_det_t when the order is down
+   * to small_max_order / 2.
+   *
+   * With an adaptive check (see enable_adaptive_check), the periodic regeneration of the inverse is scheduled here
+   * instead of in the det: the interval between two checks is doubled while the measured deviation is below
+   * precision_warning / 4, and halved when it is above precision_warning / 2.
+   */
+  class det_t {
+    // Mutable, as reading the inverse applies the pending updates of a delayed_det_t, which does not change the det
+    mutable std::variant<det_manip_t, delayed_det_t, small_det_t> impl;
+
+    static std::variant<det_manip_t, delayed_det_t, small_det_t> make(Delta_block_adaptor f, long init_size,
+                                                                      long n_delayed, bool small) {
+      if (small) return small_det_t{std::move(f)};
+      if (n_delayed > 0) return delayed_det_t{std::move(f), n_delayed};
+      return det_manip_t{std::move(f), init_size};
+    }
+
+    // Construction parameters, to rebuild the det when its order crosses small_max_order
+    long init_size = 100, n_delayed = 0, small_max_order = 0;
+
+    // Parameters of the det, applied again when it is rebuilt
+    long n_operations_before_check = 100;
+    double singular_threshold      = -1;
+
+    // Rebuild the det as a small_det_t (or not), for the same operators
+    void rebuild(bool small);
+
+    decltype(auto) visit(auto &&fun) const {
+      return std::visit(std::forward<decltype(fun)>(fun), impl);
+    }
+
+    // Ordered copy of the inverse matrix, for inverse_matrix()
+    mutable nda::matrix<double> inverse_buffer;
+
+    // Adaptive precision checks
+    bool adaptive_check           = false;
+    long check_interval           = 100;
+    long n_operations_since_check = 0;
+    long n_checks                 = 0;
+    double max_drift              = 0;
+    double precision_warning = 1.e-8, precision_error = 1.e-5;
+    static constexpr long max_check_interval = 1000000;
+
+    // Regenerate the det, and adapt the interval to the measured deviation
+    void adaptive_check_step();
+
+    public:
+    det_t(Delta_block_adaptor f, long init_size_, long n_delayed_updates = 0, long small_max_order_ = 0)
+       : impl(make(std::move(f), init_size_, n_delayed_updates, small_max_order_ > 0)),
+         init_size(init_size_),
+         n_delayed(n_delayed_updates),
+         small_max_order(small_max_order_) {}
+
+    /// Is the det currently a small_det_t?
+    [[nodiscard]] bool is_small() const { return std::holds_alternative<small_det_t>(impl); }
+
+    [[nodiscard]] long size() const {
+      return visit([](auto const &d) { return long(d.size()); });
+    }
+    [[nodiscard]] std::pair<tau_t, int> get_x(long i) const {
+      return visit([i](auto const &d) { return d.get_x(i); });
+    }
+    [[nodiscard]] std::pair<tau_t, int> get_y(long j) const {
+      return visit([j](auto const &d) { return d.get_y(j); });
+    }
+
+    /// Element (j, i) of the inverse matrix. Applies the pending updates of a delayed det first.
+    [[nodiscard]] double inverse_matrix(long j, long i) const {
+      if (auto *d = std::get_if<delayed_det_t>(&impl)) d->apply_pending();
+      return visit([i, j](auto const &d) { return d.inverse_matrix(j, i); });
+    }
+
+    /// The inverse matrix, with elements (j, i) as above, for the loops over all the elements (e.g. in the measures).
+    /// Applies the pending updates of a delayed det first. Valid until the next operation on the det.
+    [[nodiscard]] nda::matrix_const_view<double> inverse_matrix() const;
+
+    double try_insert(long i, long j, std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y) {
+      return visit([&](auto &d) { return d.try_insert(i, j, x, y); });
+    }
+    double try_remove(long i, long j) {
+      return visit([&](auto &d) { return d.try_remove(i, j); });
+    }
+    // Change the row i to x and the column j to y (the times of x and y must keep the order of the det)
+    double try_change_col_row(long i, long j, std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y) {
+      return visit([&](auto &d) { return d.try_change_col_row(i, j, x, y); });
+    }
+    // Change the row i to x only (resp. the column j to y only), with the same ordering constraint.
+    // The other dets do it as a col_row change with an unchanged column (resp. row), i.e. a rank-1 update.
+    double try_change_row(long i, std::pair<tau_t, int> const &x) {
+      return visit([&](auto &d) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(d)>, det_manip_t>)
+          return d.try_change_row(i, x);
+        else
+          return d.try_change_col_row(i, 0, x, std::pair<tau_t, int>{d.get_y(0)});
+      });
+    }
+    double try_change_col(long j, std::pair<tau_t, int> const &y) {
+      return visit([&](auto &d) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(d)>, det_manip_t>)
+          return d.try_change_col(j, y);
+        else
+          return d.try_change_col_row(0, j, std::pair<tau_t, int>{d.get_x(0)}, y);
+      });
+    }
+    // Replace all the rows and columns by x and y (in increasing time order), with M computed from scratch
+    double try_refill(std::vector<std::pair<tau_t, int>> const &x, std::vector<std::pair<tau_t, int>> const &y) {
+      return visit([&](auto &d) { return d.try_refill(x, y); });
+    }
+    void complete_operation() {
+      visit([](auto &d) { d.complete_operation(); });
+      if (adaptive_check and ++n_operations_since_check >= check_interval) adaptive_check_step();
+      if (small_max_order > 0) {
+        if (is_small() and size() > small_max_order)
+          rebuild(false);
+        else if (not is_small() and 2 * size() <= small_max_order)
+          rebuild(true);
+      }
+    }
+    void reject_last_try() {
+      visit([](auto &d) { d.reject_last_try(); });
+    }
+
+    void set_n_operations_before_check(long n) {
+      n_operations_before_check = n;
+      visit([n](auto &d) { d.set_n_operations_before_check(n); });
+    }
+    void set_precision_warning(double p) {
+      precision_warning = p;
+      visit([p](auto &d) { d.set_precision_warning(p); });
+    }
+    void set_precision_error(double p) {
+      precision_error = p;
+      visit([p](auto &d) { d.set_precision_error(p); });
+    }
+    void set_singular_threshold(double t) {
+      singular_threshold = t;
+      visit([t](auto &d) { d.set_singular_threshold(t); });
+    }
+
+    /// Schedule the precision checks adaptively, starting with initial_interval operations between checks
+    void enable_adaptive_check(long initial_interval);
+
+    /// Current number of operations between two adaptive checks
+    [[nodiscard]] long adaptive_check_interval() const { return check_interval; }
+
+    /// Number of adaptive checks so far
+    [[nodiscard]] long n_adaptive_checks() const { return n_checks; }
+
+    /// Largest deviation of the inverse measured by the adaptive checks
+    [[nodiscard]] double max_measured_drift() const { return max_drift; }
+  };
 
 } // namespace triqs_ctseg
@@ -0,0 +1,106 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include "./tau_t.hpp"
+
+namespace triqs_ctseg {
+
+  /**
+   * A real function $f(\tau)$, tabulated on a uniform grid of $[0,\beta]$ and evaluated by linear interpolation.
+   * A view on the data of an interp_table_t (it does not own the data).
+   */
+  class interp_function_t {
+    double const *p;  // (value, slope) pairs, one per interval
+    long n_intervals; // Number of intervals of the grid
+
+    public:
+    interp_function_t(double const *p_, long n_intervals_) : p(p_), n_intervals(n_intervals_) {}
+
+    /// $f(\tau)$
+    double operator()(tau_t const &tau) const {
+      double x         = tau.grid_position(n_intervals);
+      long i           = std::min(long(x), n_intervals - 1); // tau = beta is in the last interval
+      double const *pi = p + 2 * i;
+      return pi[0] + (x - double(i)) * pi[1];
+    }
+  };
+
+  /**
+   * A matrix of real functions $f_{ab}(\tau)$, $a < n_1$, $b < n_2$, tabulated on a uniform grid of $[0,\beta]$
+   * and evaluated by linear interpolation.
+   *
+   * For each interval of the grid, the value at the left point and the slope are stored next to each other,
+   * and the functions are stored one after the other in a single contiguous array.
+   * The interval is found directly from the integer representation of the tau_t,
+   * so that an evaluation is a multiplication, a cast and one (value, slope) read.
+   * The functions can also be indexed by a single index k = a * n_2 + b.
+   */
+  class interp_table_t {
+
+    long n2          = 1; // Second dimension of the matrix
+    long n_intervals = 1; // Number of intervals of the grid (number of points - 1)
+    std::vector<double> data; // data[2 * (k * n_intervals + i)] (resp. + 1) : value (resp. slope) of f_k on interval i
+
+    public:
+    interp_table_t() = default;
+
+    /// Table of n1 x n2 zero functions on a grid of n_tau points.
+    interp_table_t(long n1, long n2_, long n_tau) : n2(n2_), n_intervals(n_tau - 1), data(2 * n1 * n2_ * (n_tau - 1), 0.0) {
+      assert(n_tau > 1);
+    }
+
+    /// Table of the real part of a matrix-valued gf<imtime> (real or complex valued)
+    template <typename G>
+    explicit interp_table_t(G const &g) : interp_table_t(g.target_shape()[0], g.target_shape()[1], g.mesh().size()) {
+      auto const &d = g.data();
+      for (long a = 0; a < g.target_shape()[0]; ++a)
+        for (long b = 0; b < n2; ++b) set(a * n2 + b, [&](long i) { return std::real(d(i, a, b)); });
+    }
+
+    /// Number of tabulated functions
+    [[nodiscard]] long n_functions() const { return long(data.size()) / (2 * n_intervals); }
+
+    /// Number of grid points
+    [[nodiscard]] long n_tau() const { return n_intervals + 1; }
+
+    /// Set $f_k$ from its values on the grid (values(i), i = 0, ..., n_tau - 1)
+    void set(long k, auto const &values) {
+      double *p = data.data() + 2 * k * n_intervals;
+      for (long i = 0; i < n_intervals; ++i) {
+        p[2 * i]     = values(i);
+        p[2 * i + 1] = values(i + 1) - values(i);
+      }
+    }
+
+    /// $f_k$, to be evaluated many times
+    [[nodiscard]] interp_function_t function(long k) const { return {data.data() + 2 * k * n_intervals, n_intervals}; }
+
+    /// $f_{ab}$, to be evaluated many times
+    [[nodiscard]] interp_function_t function(long a, long b) const { return function(a * n2 + b); }
+
+    /// $f_k(\tau)$
+    double operator()(long k, tau_t const &tau) const { return function(k)(tau); }
+
+    /// $f_{ab}(\tau)$
+    double operator()(long a, long b, tau_t const &tau) const { return function(a * n2 + b)(tau); }
+  };
+
+} // namespace triqs_ctseg
@@ -25,6 +25,9 @@ namespace triqs_ctseg {
     check_segments(config);
     check_dets(config, wdata);
     check_jlines(config);
+    check_occupancy(config);
+    if (wdata.use_K_field) check_K_field(config, wdata);
+    check_sign(config, wdata);
   }
 
   void check_segments(configuration_t const &config) {
@@ -49,7 +52,7 @@ namespace triqs_ctseg {
   void check_dets(configuration_t const &config, work_data_t const &wdata) {
     for (auto bl : range(wdata.dets.size())) {
       auto const &D    = wdata.dets[bl];
-      auto const n_orb = wdata.gf_struct[bl].second;
+      auto const n_orb = long(wdata.det_colors[bl].size());
       // Times in det must be ordered
       if (D.size() != 0) {
         for (int i = 0; i < D.size() - 1; ++i) {
@@ -92,6 +95,17 @@ namespace triqs_ctseg {
                      D.size() - n_hyb_c, config);
       ALWAYS_EXPECTS(n_hyb_cdag == D.size(), "Det error, block {}: missing {} cdag times in det. Config: {}", bl,
                      D.size() - n_hyb_cdag, config);
+      // The time sets must hold the times of the det
+      if (wdata.offdiag_Delta) {
+        ALWAYS_EXPECTS(wdata.c_times[bl].size() == D.size() and wdata.cdag_times[bl].size() == D.size(),
+                       "Det error, block {}: time sets of size {}, {} for a det of size {}. Config: {}", bl,
+                       wdata.c_times[bl].size(), wdata.cdag_times[bl].size(), D.size(), config);
+        for (int i = 0; i < D.size(); ++i)
+          ALWAYS_EXPECTS(wdata.c_times[bl].contains(D.get_y(i).first)
+                            and wdata.cdag_times[bl].contains(D.get_x(i).first),
+                         "Det error, block {}: times at position {} are not in the time sets. Config: {}", bl, i,
+                         config);
+      }
     }
     LOG("Dets OK.");
   }
@@ -152,4 +166,33 @@ namespace triqs_ctseg {
     LOG("J lines OK.");
   }
 
+  void check_occupancy(configuration_t const &config) {
+    // The occupancy index of each color must agree with the one recomputed from the seglist
+    for (auto const &[c, sl] : itertools::enumerate(config.seglists)) {
+      occupancy_index_t occ;
+      occ.reset(sl);
+      ALWAYS_EXPECTS((occ == config.occupancy[c]), "Error: occupancy index of color {} is not up to date", c);
+    }
+    LOG("Occupancy index OK.");
+  }
+
+  void check_K_field(configuration_t const &config, work_data_t const &wdata) {
+    // The incrementally updated field must agree with the field recomputed from the configuration
+    auto field = wdata.K_field;
+    field.reset(wdata.K_field_table(), config.seglists);
+    auto diff = field.max_difference(wdata.K_field);
+    ALWAYS_EXPECTS(diff < 1.e-8, "Error: K field deviates by {} from its value for the configuration \n{}", diff,
+                   config);
+    LOG("K field OK.");
+  }
+
+  void check_sign(configuration_t const &config, work_data_t const &wdata) {
+    // The incrementally tracked sign must agree with the sign recomputed from the dets
+    auto sign = trace_sign(wdata);
+    ALWAYS_EXPECTS(sign == wdata.tracked_trace_sign(),
+                   "Error: tracked sign {} differs from the trace sign {} in config \n{}", wdata.tracked_trace_sign(),
+                   sign, config);
+    LOG("Sign OK.");
+  }
+
 } // namespace triqs_ctseg
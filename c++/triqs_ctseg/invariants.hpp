@@ -30,4 +30,10 @@ namespace triqs_ctseg {
 
   void check_jlines(configuration_t const &config);
 
+  void check_occupancy(configuration_t const &config);
+
+  void check_K_field(configuration_t const &config, work_data_t const &wdata);
+
+  void check_sign(configuration_t const &config, work_data_t const &wdata);
+
 } // namespace triqs_ctseg
@@ -18,7 +18,10 @@
 #pragma once
 
 #include "./measures/G_F_tau.hpp"
+#include "./measures/G_F_l.hpp"
+#include "./measures/G_F_iw.hpp"
 #include "./measures/nn_tau.hpp"
+#include "./measures/nn_iw.hpp"
 #include "./measures/Sperp_tau.hpp"
 #include "./measures/nn_static.hpp"
 #include "./measures/densities.hpp"
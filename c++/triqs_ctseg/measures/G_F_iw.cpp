@@ -0,0 +1,119 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+#include "./G_F_iw.hpp"
+#include "./G_F_tau.hpp"
+#include "../logs.hpp"
+
+namespace triqs_ctseg::measures {
+
+  fermionic_nufft_t::fermionic_nufft_t(double beta, int n_iw) : beta{beta}, n_iw{n_iw} {
+    // 2 n_iw frequencies, on a grid oversampled by R = 2
+    double n_modes = 2 * n_iw;
+    n_grid         = std::max(2 * 2 * n_iw, 2 * n_spread + 2);
+    double R       = n_grid / n_modes;
+    kernel_tau     = M_PI * n_spread / (n_modes * n_modes * R * (R - 0.5));
+  }
+
+  // -------------------------------------
+
+  // Direct transform of the grid, done once, and deconvolution of the kernel
+  nda::matrix<dcomplex> fermionic_nufft_t::transform(nda::array<dcomplex, 3> const &grid, long n) const {
+    auto result = nda::matrix<dcomplex>(grid.extent(1), grid.extent(2));
+    result      = 0;
+    auto e_inc  = std::exp(dcomplex(0, 2 * M_PI * n / n_grid));
+    dcomplex e  = 1;
+    for (long m = 0; m < n_grid; ++m) {
+      result += grid(m, range::all, range::all) * e;
+      e *= e_inc;
+    }
+    return result * (std::sqrt(M_PI / kernel_tau) * std::exp(n * n * kernel_tau) / n_grid);
+  }
+
+  // -------------------------------------
+
+  G_F_iw::G_F_iw(params_t const &p, work_data_t const &wdata, configuration_t const &config, results_t &results)
+     : wdata{wdata}, config{config}, results{results}, nufft{p.beta, p.n_iw_G} {
+
+    beta         = p.beta;
+    measure_F_iw = p.measure_F_iw and wdata.rot_inv;
+    gf_struct    = p.gf_struct;
+    ALWAYS_EXPECTS((p.n_iw_G > 0), "Error: n_iw_G = {} must be > 0 to measure G_iw", p.n_iw_G);
+
+    for (auto const &[bl_name, bl_size] : gf_struct) {
+      G_grid.emplace_back(nda::zeros<dcomplex>(nufft.n_grid, bl_size, bl_size));
+      F_grid.emplace_back(nda::zeros<dcomplex>(nufft.n_grid, bl_size, bl_size));
+    }
+  }
+
+  // -------------------------------------
+
+  void G_F_iw::accumulate(double s) {
+
+    LOG("\n =================== MEASURE G(iw) ================ \n");
+
+    Z += s;
+
+    for (auto [bl_idx, det] : itertools::enumerate(wdata.dets)) {
+      long N             = det.size();
+      auto M_inv         = det.inverse_matrix();
+      auto const &colors = wdata.det_colors[bl_idx];
+      // The block of gf_struct of the det, and the index in this block of the colors of the det
+      auto &g    = G_grid[wdata.gf_block_number[colors[0]]];
+      auto &f    = F_grid[wdata.gf_block_number[colors[0]]];
+      auto index = [&](int k) { return wdata.gf_index_in_block[colors[k]]; };
+      for (long id_y : range(N)) {
+        auto y        = det.get_y(id_y);
+        double f_fact = 0;
+        if (measure_F_iw) f_fact = fprefactor(wdata, config, bl_idx, y);
+        for (long id_x : range(N)) {
+          auto x    = det.get_x(id_x);
+          auto Minv = M_inv(id_y, id_x);
+          // beta-periodicity is implicit in the argument, just fix the sign properly
+          auto val  = (y.first >= x.first ? s : -s) * Minv;
+          auto dtau = double(y.first - x.first);
+          auto i = index(y.second), j = index(x.second);
+          nufft.spread(dtau, val, [&](long m, dcomplex w) {
+            g(m, i, j) += w;
+            if (measure_F_iw) f(m, i, j) += w * f_fact;
+          });
+        }
+      }
+    }
+  }
+
+  // -------------------------------------
+
+  void G_F_iw::collect_results(mpi::communicator const &c) {
+
+    Z = mpi::all_reduce(Z, c);
+
+    // Transform the grids to the frequencies n = -n_iw, ..., n_iw - 1, and normalize as G_tau
+    auto transform = [&](std::vector<nda::array<dcomplex, 3>> const &grids) {
+      auto result = block_gf<imfreq>{triqs::mesh::imfreq{beta, Fermion, nufft.n_iw}, gf_struct};
+      for (auto bl : range(grids.size())) {
+        auto grid = mpi::all_reduce(grids[bl], c);
+        auto &gw  = result[bl];
+        for (auto const &w : gw.mesh()) gw[w] = nufft.transform(grid, w.index()) / (-beta * Z);
+      }
+      return result;
+    };
+
+    results.G_iw = transform(G_grid);
+    if (measure_F_iw) results.F_iw = transform(F_grid);
+  }
+
+} // namespace triqs_ctseg::measures
@@ -0,0 +1,80 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+#pragma once
+#include <cmath>
+#include "../configuration.hpp"
+#include "../work_data.hpp"
+#include "../results.hpp"
+
+namespace triqs_ctseg::measures {
+
+  // Non-uniform Fourier transform sum_k v_k e^{i omega_n tau_k} on the fermionic frequencies omega_n, n = -n_iw, ...,
+  // n_iw - 1, by gridding (Greengard and Lee, SIAM Rev. 46, 443 (2004)). Each value is spread on a regular grid of
+  // tau, oversampled by 2, with a Gaussian kernel over 2 n_spread points. The grid is linear in the values, so it
+  // can be accumulated over many terms, and is transformed and deconvolved only once.
+  struct fermionic_nufft_t {
+
+    double beta;
+    // Kernel exp(-(x - x_m)^2 / (4 kernel_tau)) for the times x = 2 pi tau / beta
+    int n_iw, n_grid, n_spread = 12;
+    double kernel_tau;
+
+    fermionic_nufft_t(double beta, int n_iw);
+
+    // Call add(m, w) for the grid points m of the spreading of v e^{i omega_n tau}, for any tau in ]-beta, beta]
+    void spread(double tau, dcomplex v, auto &&add) const {
+      // omega_n = (2n + 1) pi / beta: the fermionic shift e^{i pi tau / beta} goes into the value
+      auto v_shifted = v * std::exp(dcomplex(0, M_PI * tau / beta));
+      double h       = 2 * M_PI / n_grid;
+      double x       = 2 * M_PI * tau / beta;
+      long m0        = long(std::floor(x / h));
+      for (long m = m0 - n_spread + 1; m <= m0 + n_spread; ++m) {
+        auto w = v_shifted * std::exp(-(x - m * h) * (x - m * h) / (4 * kernel_tau));
+        add(((m % n_grid) + n_grid) % n_grid, w); // The grid is 2 pi periodic in x
+      }
+    }
+
+    // The transform at omega_n of a grid of matrices (grid point, i, j)
+    [[nodiscard]] nda::matrix<dcomplex> transform(nda::array<dcomplex, 3> const &grid, long n) const;
+  };
+
+  // G(i omega_n) and its improved estimator F(i omega_n), accumulated directly from the det entries,
+  // G(i omega_n) = - 1/beta < sum M_yx e^{i omega_n (tau_y - tau_x)} >, by a non-uniform Fourier transform.
+  // The grids of the transform are accumulated over the configurations, and are transformed once, in
+  // collect_results. See G_F_tau.
+  struct G_F_iw {
+
+    work_data_t const &wdata;
+    configuration_t const &config;
+    results_t &results;
+    double beta;
+    bool measure_F_iw;
+    gf_struct_t gf_struct;
+    fermionic_nufft_t nufft;
+
+    // Accumulated grids, for each block of gf_struct: (grid point, i, j)
+    std::vector<nda::array<dcomplex, 3>> G_grid, F_grid;
+
+    double Z = 0;
+
+    G_F_iw(params_t const &params, work_data_t const &wdata, configuration_t const &config, results_t &results);
+
+    void accumulate(double s);
+    void collect_results(mpi::communicator const &c);
+  };
+
+} // namespace triqs_ctseg::measures
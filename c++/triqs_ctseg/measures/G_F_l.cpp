@@ -0,0 +1,101 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+#include "./G_F_l.hpp"
+#include "./G_F_tau.hpp"
+#include "../logs.hpp"
+#include <triqs/utility/legendre.hpp>
+
+namespace triqs_ctseg::measures {
+
+  G_F_l::G_F_l(params_t const &p, work_data_t const &wdata, configuration_t const &config, results_t &results)
+     : wdata{wdata}, config{config}, results{results} {
+
+    beta        = p.beta;
+    measure_F_l = p.measure_F_l and wdata.rot_inv;
+    n_l         = p.n_legendre_G;
+
+    G_l   = block_gf<legendre>{triqs::mesh::legendre{beta, Fermion, n_l}, p.gf_struct};
+    F_l   = block_gf<legendre>{triqs::mesh::legendre{beta, Fermion, n_l}, p.gf_struct};
+    G_l() = 0;
+    F_l() = 0;
+  }
+
+  // -------------------------------------
+
+  void G_F_l::accumulate(double s) {
+
+    LOG("\n =================== MEASURE G_l ================ \n");
+
+    Z += s;
+
+    // P_l(x) by the recurrence (l + 1) P_{l+1} = (2l + 1) x P_l - l P_{l-1}
+    triqs::utility::legendre_generator P;
+
+    for (auto [bl_idx, det] : itertools::enumerate(wdata.dets)) {
+      long N             = det.size();
+      auto M_inv         = det.inverse_matrix();
+      auto const &colors = wdata.det_colors[bl_idx];
+      // The block of gf_struct of the det, and the index in this block of the colors of the det
+      auto &g    = G_l[wdata.gf_block_number[colors[0]]];
+      auto &f    = F_l[wdata.gf_block_number[colors[0]]];
+      auto index = [&](int k) { return wdata.gf_index_in_block[colors[k]]; };
+      for (long id_y : range(N)) {
+        auto y        = det.get_y(id_y);
+        double f_fact = 0;
+        if (measure_F_l) f_fact = fprefactor(wdata, config, bl_idx, y);
+        for (long id_x : range(N)) {
+          auto x    = det.get_x(id_x);
+          auto Minv = M_inv(id_y, id_x);
+          // beta-periodicity is implicit in the argument, just fix the sign properly
+          auto val  = (y.first >= x.first ? s : -s) * Minv;
+          auto dtau = double(y.first - x.first);
+          auto i = index(y.second), j = index(x.second);
+          P.reset(2 * dtau / beta - 1);
+          for (long l = 0; l < n_l; ++l) {
+            double val_l = val * P.next();
+            g.data()(l, i, j) += val_l;
+            if (measure_F_l) f.data()(l, i, j) += val_l * f_fact;
+          }
+        }
+      }
+    }
+  }
+
+  // -------------------------------------
+
+  void G_F_l::collect_results(mpi::communicator const &c) {
+
+    Z = mpi::all_reduce(Z, c);
+
+    // Normalization -sqrt(2l + 1) / beta, as for G_tau
+    auto normalize = [this](block_gf<legendre> &gl) {
+      for (auto &g : gl)
+        for (long l = 0; l < n_l; ++l) g.data()(l, range::all, range::all) *= -std::sqrt(2 * l + 1) / (beta * Z);
+    };
+
+    G_l = mpi::all_reduce(G_l, c);
+    normalize(G_l);
+    results.G_l = std::move(G_l);
+
+    if (measure_F_l) {
+      F_l = mpi::all_reduce(F_l, c);
+      normalize(F_l);
+      results.F_l = std::move(F_l);
+    }
+  }
+
+} // namespace triqs_ctseg::measures
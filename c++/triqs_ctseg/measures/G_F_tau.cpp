@@ -43,21 +43,25 @@ namespace triqs_ctseg::measures {
     Z += s;
 
     for (auto [bl_idx, det] : itertools::enumerate(wdata.dets)) {
-      long N  = det.size();
-      auto &g = G_tau[bl_idx];
-      auto &f = F_tau[bl_idx];
+      long N             = det.size();
+      auto M_inv         = det.inverse_matrix();
+      auto const &colors = wdata.det_colors[bl_idx];
+      // The block of gf_struct of the det, and the index in this block of the colors of the det
+      auto &g    = G_tau[wdata.gf_block_number[colors[0]]];
+      auto &f    = F_tau[wdata.gf_block_number[colors[0]]];
+      auto index = [&](int k) { return wdata.gf_index_in_block[colors[k]]; };
       for (long id_y : range(N)) {
         auto y        = det.get_y(id_y);
         double f_fact = 0;
-        if (measure_F_tau) f_fact = fprefactor(bl_idx, y);
+        if (measure_F_tau) f_fact = fprefactor(wdata, config, bl_idx, y);
         for (long id_x : range(N)) {
           auto x    = det.get_x(id_x);
-          auto Minv = det.inverse_matrix(id_y, id_x);
+          auto Minv = M_inv(id_y, id_x);
           // beta-periodicity is implicit in the argument, just fix the sign properly
           auto val  = (y.first >= x.first ? s : -s) * Minv;
           auto dtau = double(y.first - x.first);
-          g[closest_mesh_pt(dtau)](y.second, x.second) += val;
-          if (measure_F_tau) f[closest_mesh_pt(dtau)](y.second, x.second) += val * f_fact;
+          g[closest_mesh_pt(dtau)](index(y.second), index(x.second)) += val;
+          if (measure_F_tau) f[closest_mesh_pt(dtau)](index(y.second), index(x.second)) += val * f_fact;
         }
       }
     }
@@ -94,7 +98,8 @@ namespace triqs_ctseg::measures {
 
   // -------------------------------------
 
-  double G_F_tau::fprefactor(long const &block, std::pair<tau_t, long> const &y) {
+  double fprefactor(work_data_t const &wdata, configuration_t const &config, long const &block,
+                    std::pair<tau_t, long> const &y) {
     int color    = wdata.block_to_color(block, y.second);
     double I_tau = 0;
     for (auto const &[c, sl] : itertools::enumerate(config.seglists)) {
@@ -102,10 +107,10 @@ namespace triqs_ctseg::measures {
       if (c != color) I_tau += wdata.U(c, color) * ntau;
       if (wdata.has_Dt) {
         I_tau -= K_overlap(sl, y.first, false, wdata.Kprime, c, color);
-        if (c == color) I_tau -= 2 * real(wdata.Kprime(0)(c, c));
+        if (c == color) I_tau -= 2 * wdata.Kprime(c, c, tau_t::zero());
       }
       if (wdata.has_Jperp) {
-        I_tau -= 4 * real(wdata.Kprime_spin(0)(c, color)) * ntau;
+        I_tau -= 4 * wdata.Kprime_spin(c, color, tau_t::zero()) * ntau;
         I_tau -= 2 * K_overlap(sl, y.first, false, wdata.Kprime_spin, c, color);
       }
     }
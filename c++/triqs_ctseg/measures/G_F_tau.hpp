@@ -40,7 +40,11 @@ namespace triqs_ctseg::measures {
 
     void accumulate(double s);
     void collect_results(mpi::communicator const &c);
-    double fprefactor(long const &block, std::pair<tau_t, long> const &y);
   };
 
+  // The prefactor I(tau) of the improved estimator F for the operator y of the det of the given block.
+  // Also used by G_F_l and G_F_iw.
+  double fprefactor(work_data_t const &wdata, configuration_t const &config, long const &block,
+                    std::pair<tau_t, long> const &y);
+
 } // namespace triqs_ctseg::measures
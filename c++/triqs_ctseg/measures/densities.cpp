@@ -32,11 +32,8 @@ namespace triqs_ctseg::measures {
   void densities::accumulate(double s) {
 
     Z += s;
-    for (auto const &[c, seglist] : itertools::enumerate(config.seglists)) {
-      double sum = 0;
-      for (auto &seg : seglist) sum += double(seg.length()); // accounts for cyclicity
-      n[c] += s * sum;
-    }
+    // Total occupied length, from the occupancy index (accounts for cyclicity)
+    for (auto const &[c, occ] : itertools::enumerate(config.occupancy)) n[c] += s * double(occ.total());
   }
 
   // -------------------------------------
@@ -202,10 +202,10 @@ namespace triqs_ctseg::measures {
       if (c != color) I_tau += wdata.U(c, color) * ntau;
       if (wdata.has_Dt) {
         I_tau -= K_overlap(sl, y.first, false, wdata.Kprime, c, color);
-        if (c == color) I_tau -= 2 * real(wdata.Kprime(0)(c, c));
+        if (c == color) I_tau -= 2 * wdata.Kprime(c, c, tau_t::zero());
       }
       if (wdata.has_Jperp) {
-        I_tau -= 4 * real(wdata.Kprime_spin(0)(c, color)) * ntau;
+        I_tau -= 4 * wdata.Kprime_spin(c, color, tau_t::zero()) * ntau;
         I_tau -= 2 * K_overlap(sl, y.first, false, wdata.Kprime_spin, c, color);
       }
     }
@@ -228,7 +228,11 @@ namespace triqs_ctseg::measures {
     }
 
     for (auto const &[bl, det] : itertools::enumerate(wdata.dets)) {
-      long N = det.size();
+      long N     = det.size();
+      auto M_inv = det.inverse_matrix();
+      // The block of gf_struct of the det, and the index in this block of the colors of the det
+      auto const &colors = wdata.det_colors[bl];
+      long gf_bl         = wdata.gf_block_number[colors[0]];
       y_exp_ini.resize(N);
       y_exp_inc.resize(N);
       x_exp_ini.resize(N);
@@ -243,8 +247,8 @@ namespace triqs_ctseg::measures {
         y_exp_inc(id) = std::exp(dcomplex(0, w_inc * double(std::get<0>(y))));
         x_exp_ini(id) = std::exp(dcomplex(0, -w_ini * double(std::get<0>(x))));
         x_exp_inc(id) = std::exp(dcomplex(0, -w_inc * double(std::get<0>(x))));
-        y_inner_index(id) = std::get<1>(y);
-        x_inner_index(id) = std::get<1>(x);
+        y_inner_index(id) = wdata.gf_index_in_block[colors[std::get<1>(y)]];
+        x_inner_index(id) = wdata.gf_index_in_block[colors[std::get<1>(x)]];
       }
 
       for (long id_y : range(N)) {
@@ -256,12 +260,12 @@ namespace triqs_ctseg::measures {
           int xi = x_inner_index(id_x);
           dcomplex y_exp = y_exp_ini(id_y);
           dcomplex x_exp = x_exp_ini(id_x);
-          auto Minv = det.inverse_matrix(id_y, id_x);
+          auto Minv = M_inv(id_y, id_x);
 
           for (int n_1 : range(n_w_aux)) {
             for (int n_2 : range(n_w_aux)) {
               auto val = Minv * y_exp * x_exp;
-              result[bl](yj, xi, n_1, n_2) += val * f_fact;
+              result[gf_bl](yj, xi, n_1, n_2) += val * f_fact;
               x_exp *= x_exp_inc(id_x);
             }
             x_exp = x_exp_ini(id_x);
@@ -0,0 +1,92 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+#include "./nn_iw.hpp"
+#include "../logs.hpp"
+
+namespace triqs_ctseg::measures {
+
+  nn_iw::nn_iw(params_t const &p, work_data_t const &wdata, configuration_t const &config, results_t &results)
+     : wdata{wdata}, config{config}, results{results} {
+
+    beta           = p.beta;
+    n_w            = p.n_iw_chi2;
+    ALWAYS_EXPECTS((n_w > 0), "Error: n_iw_chi2 = {} must be > 0 to measure nn_iw", n_w);
+    n_color        = config.n_color();
+    block_number   = wdata.gf_block_number;
+    index_in_block = wdata.gf_index_in_block;
+
+    nn_w_acc  = nda::zeros<dcomplex>(n_w, n_color, n_color);
+    n_w_color = nda::zeros<dcomplex>(n_w, n_color);
+  }
+
+  // -------------------------------------
+
+  void nn_iw::accumulate(double s) {
+
+    LOG("\n =================== MEASURE nn(i nu) ================ \n");
+
+    Z += s;
+
+    // n_a(i nu_m), with the exponentials e^{i nu_m tau} computed by recurrence on m, as in four_point::compute_Mw
+    double w_inc = 2 * M_PI / beta;
+    n_w_color()  = 0;
+    for (int a = 0; a < n_color; ++a)
+      for (auto const &seg : config.seglists[a]) {
+        n_w_color(0, a) += double(seg.length());
+        if (is_full_line(seg)) continue; // 0 for nu != 0
+        auto c_exp_inc    = std::exp(dcomplex(0, w_inc * double(seg.tau_c)));
+        auto cdag_exp_inc = std::exp(dcomplex(0, w_inc * double(seg.tau_cdag)));
+        dcomplex c_exp = c_exp_inc, cdag_exp = cdag_exp_inc;
+        for (int m = 1; m < n_w; ++m) {
+          n_w_color(m, a) += (c_exp - cdag_exp) / dcomplex(0, w_inc * m);
+          c_exp *= c_exp_inc;
+          cdag_exp *= cdag_exp_inc;
+        }
+      }
+
+    for (int m = 0; m < n_w; ++m)
+      for (int a = 0; a < n_color; ++a)
+        for (int b = 0; b < n_color; ++b) nn_w_acc(m, a, b) += s * n_w_color(m, a) * std::conj(n_w_color(m, b));
+  }
+
+  // -------------------------------------
+
+  void nn_iw::collect_results(mpi::communicator const &c) {
+
+    Z        = mpi::all_reduce(Z, c);
+    nn_w_acc = mpi::all_reduce(nn_w_acc, c);
+    nn_w_acc = nn_w_acc / (beta * Z);
+
+    auto nn_w = gf<imfreq>({beta, Boson, n_w}, {n_color, n_color});
+    for (auto const &w : nn_w.mesh()) {
+      long m = w.index();
+      for (int a = 0; a < n_color; ++a)
+        for (int b = 0; b < n_color; ++b) nn_w[w](a, b) = (m >= 0) ? nn_w_acc(m, a, b) : std::conj(nn_w_acc(-m, a, b));
+    }
+
+    // store the result
+    auto nn_w_block = make_block2_gf<imfreq>({beta, Boson, n_w}, wdata.gf_struct);
+    for (int c1 : range(n_color)) {
+      for (int c2 : range(n_color)) {
+        nn_w_block(block_number[c1], block_number[c2]).data()(range::all, index_in_block[c1], index_in_block[c2]) =
+           nn_w.data()(range::all, c1, c2);
+      }
+    }
+    results.nn_iw = std::move(nn_w_block);
+  }
+
+} // namespace triqs_ctseg::measures
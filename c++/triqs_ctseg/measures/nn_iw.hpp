@@ -0,0 +1,48 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+#pragma once
+#include "../configuration.hpp"
+#include "../work_data.hpp"
+#include "../results.hpp"
+
+namespace triqs_ctseg::measures {
+
+  // <n_a(i nu) n_b(-i nu)> / beta, i.e. the Fourier transform of <n_a(tau) n_b(0)>, from the analytic transform
+  // n_a(i nu) = sum over the segments of (e^{i nu tau_c} - e^{i nu tau_cdag}) / (i nu) of the occupancies.
+  struct nn_iw {
+
+    work_data_t const &wdata;
+    configuration_t const &config;
+    results_t &results;
+    double beta;
+    int n_w; // Number of non-negative bosonic frequencies
+    std::vector<long> block_number, index_in_block;
+
+    // Accumulated <n_a(i nu_m) n_b(-i nu_m)>, for m >= 0 (m < 0 by conjugation)
+    nda::array<dcomplex, 3> nn_w_acc;
+    nda::array<dcomplex, 2> n_w_color; // n_a(i nu_m) of the current configuration
+
+    double Z = 0;
+    int n_color;
+
+    nn_iw(params_t const &params, work_data_t const &wdata, configuration_t const &config, results_t &results);
+
+    void accumulate(double s);
+    void collect_results(mpi::communicator const &c);
+  };
+
+} // namespace triqs_ctseg::measures
@@ -38,10 +38,8 @@ namespace triqs_ctseg::measures {
 
     for (int a = 0; a < n_color; ++a)
       for (int b = 0; b < n_color; ++b) {
-        for (auto const &sa : config.seglists[a]) {
-          for (auto const &sb : config.seglists[b]) //
-            nn(a, b) += s * overlap(sa, sb);
-        }
+        // Overlap of each segment of a with the seglist of b, from the occupancy index of b
+        for (auto const &sa : config.seglists[a]) nn(a, b) += s * overlap(config, b, sa);
       }
   }
   // -------------------------------------
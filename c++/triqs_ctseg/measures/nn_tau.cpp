@@ -27,9 +27,12 @@ namespace triqs_ctseg::measures {
     ntau           = p.n_tau_chi2;
     dtau           = p.beta / (ntau - 1);
     n_color        = config.n_color();
-    block_number   = wdata.block_number;
-    index_in_block = wdata.index_in_block;
+    average        = p.nn_tau_average;
+    block_number   = wdata.gf_block_number;
+    index_in_block = wdata.gf_index_in_block;
 
+    q_tau_diff       = nda::zeros<double>(ntau + 1, n_color, n_color);
+    q_tau_slope_diff = nda::zeros<double>(ntau + 1, n_color, n_color);
     q_tau       = gf<imtime>({beta, Boson, ntau}, {n_color, n_color});
     q_tau()     = 0;
     q_tau_block = make_block2_gf<imtime>({beta, Boson, ntau}, p.gf_struct);
@@ -46,6 +49,11 @@ namespace triqs_ctseg::measures {
 
     Z += s;
 
+    if (average) {
+      accumulate_average(s);
+      return;
+    }
+
     // <n_a(tau) n_b(0) >
     for (int b = 0; b < n_color; ++b) {
       if (n_at_boundary(config.seglists[b]) == 0) continue; // nb = 0, nothing to accumulate
@@ -57,11 +65,12 @@ namespace triqs_ctseg::measures {
           // find closest mesh point to the left of cdag
           int u_idx_cdag = int(std::ceil(seg.tau_cdag / dtau));
 
-          auto d = q_tau.data()(nda_all, a, b); // a view of the data for fixed a,b
-          // add + s to the data. NB : id1 > id2
+          auto d = q_tau_diff(nda_all, a, b); // a view of the difference array for fixed a,b
+          // add + s to the points u_idx1 >= u >= u_idx2, i.e. two markers in the difference array
           auto fill = [s, &d](long u_idx1, long u_idx2) {
             ALWAYS_EXPECTS((u_idx1 >= u_idx2), "error", 1);
-            for (auto u = u_idx1; u >= u_idx2; --u) d(u) += s;
+            d(u_idx2) += s;
+            d(u_idx1 + 1) -= s;
           };
 
           // Execute with 2 cases : cyclic segment or not
@@ -78,11 +87,81 @@ namespace triqs_ctseg::measures {
 
   // -------------------------------------
 
+  // F_ab(tau) = 1/beta int_0^beta dt n_a(t + tau) n_b(t) is piecewise linear in tau. Its slope jumps by s_x j_y / beta
+  // at tau = x - y, for any operator x of color a (s_x = 1 for cdag, -1 for c) and y of color b (j_y = 1 for c, -1
+  // for cdag). F_ab(0) is the overlap of a and b, and the initial slope follows from int_0^beta F_ab = L_a L_b / beta,
+  // with L the total length of the segments.
+  void nn_tau::accumulate_average(double s) {
+
+    // Operators of a color, with s_x for color a, i.e. -j_y for color b. A full line has none.
+    auto ops = [](seglist_t const &sl) {
+      std::vector<std::pair<double, double>> result;
+      for (auto const &seg : sl) {
+        if (is_full_line(seg)) continue;
+        result.emplace_back(double(seg.tau_cdag), 1);
+        result.emplace_back(double(seg.tau_c), -1);
+      }
+      return result;
+    };
+    auto total_length = [](seglist_t const &sl) {
+      double result = 0;
+      for (auto const &seg : sl) result += double(seg.length());
+      return result;
+    };
+
+    for (int a = 0; a < n_color; ++a) {
+      auto const &sl_a = config.seglists[a];
+      if (sl_a.empty()) continue;
+      auto ops_a = ops(sl_a);
+      double L_a = total_length(sl_a);
+      for (int b = 0; b < n_color; ++b) {
+        auto const &sl_b = config.seglists[b];
+        if (sl_b.empty()) continue;
+        auto ops_b = ops(sl_b);
+
+        double F0 = 0;
+        for (auto const &seg : sl_a) F0 += overlap(config, b, seg);
+        double sum_kinks = 0; // sum of the c_k (beta - t_k)^2 / 2
+
+        auto d       = q_tau_diff(nda_all, a, b);
+        auto d_slope = q_tau_slope_diff(nda_all, a, b);
+        for (auto const &[x, s_x] : ops_a)
+          for (auto const &[y, s_y] : ops_b) {
+            double t = x - y;
+            if (t < 0) t += beta;
+            double c = -s_x * s_y / beta;
+            sum_kinks += c * (beta - t) * (beta - t) / 2;
+            // Kink in c * (tau - t) for tau > t
+            long u0 = long(std::floor(t / dtau)) + 1;
+            if (u0 < ntau) {
+              d_slope(u0) += s * c;
+              d(u0) -= s * c * t;
+            }
+          }
+        double slope0 = (L_a * total_length(sl_b) / beta - F0 - sum_kinks) * 2 / (beta * beta);
+        d(0) += s * F0 / beta;
+        d_slope(0) += s * slope0;
+      }
+    }
+  }
+
+  // -------------------------------------
+
   void nn_tau::collect_results(mpi::communicator const &c) {
 
     Z = mpi::all_reduce(Z, c);
 
-    q_tau = mpi::all_reduce(q_tau, c);
+    q_tau_diff       = mpi::all_reduce(q_tau_diff, c);
+    q_tau_slope_diff = mpi::all_reduce(q_tau_slope_diff, c);
+
+    // Integrate the difference arrays
+    auto d       = nda::zeros<double>(n_color, n_color);
+    auto d_slope = nda::zeros<double>(n_color, n_color);
+    for (int u = 0; u < ntau; ++u) {
+      d += q_tau_diff(u, nda_all, nda_all);
+      d_slope += q_tau_slope_diff(u, nda_all, nda_all);
+      q_tau.data()(u, nda_all, nda_all) = d + (u * dtau) * d_slope;
+    }
     q_tau = q_tau / Z; //(beta * Z * q_tau.mesh().delta());
 
     // store the result
@@ -32,15 +32,21 @@ namespace triqs_ctseg::measures {
     int ntau;
     std::vector<long> block_number, index_in_block;
 
+    // Difference arrays of <n_a(tau) n_b(0)> on the mesh: a segment covering the points u1 >= u >= u2 adds
+    // s at u2 and -s at u1 + 1. In the averaged estimator, which is piecewise linear in tau, the slope has its own
+    // difference array. Integrated over tau in collect_results.
+    nda::array<double, 3> q_tau_diff, q_tau_slope_diff;
     gf<imtime> q_tau;
     block2_gf<imtime> q_tau_block;
 
     double Z = 0;
     int n_color;
+    bool average; // Average over the reference time (nn_tau_average)
 
     nn_tau(params_t const &params, work_data_t const &wdata, configuration_t const &config, results_t &results);
 
     void accumulate(double s);
+    void accumulate_average(double s);
     void collect_results(mpi::communicator const &c);
   };
 
@@ -27,3 +27,6 @@
 #include "./moves/split_spin_segment.hpp"
 #include "./moves/regroup_spin_segment.hpp"
 #include "./moves/swap_spin_lines.hpp"
+#include "./moves/shift_segment_end.hpp"
+#include "./moves/permute_colors.hpp"
+#include "./moves/tuned_move_set.hpp"
@@ -0,0 +1,77 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include "heat_bath_color.hpp"
+#include <cmath>
+
+namespace triqs_ctseg::moves {
+
+  std::vector<double> heat_bath_color_weights(configuration_t const &config, work_data_t const &wdata,
+                                              tau_t const &tau_c, tau_t const &tau_cdag, bool cut,
+                                              int reverse_color) {
+
+    // The piece of the time line which gets occupied (s = 1) or emptied (s = -1)
+    auto piece = (cut ? segment_t{tau_cdag, tau_c} : segment_t{tau_c, tau_cdag});
+    double s   = (cut ? -1 : 1);
+    double len = double(piece.length());
+
+    auto w = std::vector<double>(config.n_color(), 0);
+    for (auto color : range(config.n_color())) {
+      auto const &sl        = config.seglists[color];
+      bool is_reverse_color = (color == reverse_color);
+      if (not is_reverse_color and not(cut ? is_inside(piece, sl) : is_insertable_into(piece, sl))) continue;
+
+      // Trace ratio, as in insert_segment and split_segment
+      double ln_trace_ratio = s * wdata.mu(color) * len;
+      for (auto c : range(config.n_color())) {
+        if (c == color) continue;
+        // In the reverse color, the piece is occupied (s = 1) or empty (s = -1) now, and not without it
+        double ov = overlap(config, c, piece) - (c == reverse_color ? s * len : 0);
+        ln_trace_ratio -= s * wdata.U(color, c) * ov;
+      }
+      if (wdata.has_Dt) {
+        ln_trace_ratio += K_overlap(config, tau_c, tau_cdag, color, wdata);
+        ln_trace_ratio -= wdata.K(color, color, piece.length()); // Correct double counting
+        // Remove the overlap with the c at tau_c and cdag at tau_cdag of the reverse color (K(0) = 0)
+        if (reverse_color >= 0) {
+          ln_trace_ratio += wdata.K(color, reverse_color, tau_cdag - tau_c);
+          ln_trace_ratio += wdata.K(color, reverse_color, tau_c - tau_cdag);
+        }
+      }
+
+      // Number of segments (insert), resp. antisegments (split), after the move
+      double future_number = (is_reverse_color ? sl.size() : ((cut and is_full_line(sl[0])) ? 1 : sl.size() + 1));
+      w[color]             = std::exp(ln_trace_ratio) / future_number;
+    }
+    return w;
+  }
+
+  // ---------------------------
+
+  int heat_bath_choice(std::vector<double> const &w, double sum_w, triqs::mc_tools::random_generator &rng) {
+    double r  = rng(sum_w);
+    int color = 0;
+    // The last color with a non-zero weight absorbs the rounding errors
+    for (; color < int(w.size()) - 1; ++color) {
+      if (r < w[color]) break;
+      r -= w[color];
+    }
+    while (w[color] == 0) --color;
+    return color;
+  }
+
+} // namespace triqs_ctseg::moves
@@ -0,0 +1,43 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#pragma once
+#include "../work_data.hpp"
+#include "../configuration.hpp"
+
+namespace triqs_ctseg::moves {
+
+  /**
+   * Weights of the heat-bath choice of the color in insert_segment and split_segment (see params_t::heat_bath_color).
+   *
+   * The move adds a c at tau_c and a cdag at tau_cdag: the segment [tau_c, tau_cdag] (insert),
+   * or the antisegment [tau_cdag, tau_c] cut out of a segment (split, cut = true).
+   * The weight of a color is the trace ratio of the move in this color times the probability of the reverse move
+   * once the color is chosen, i.e. 1 / (number of segments, resp. antisegments, after the move).
+   * It is 0 if the move is not possible in this color.
+   *
+   * For the reverse move (remove, regroup), reverse_color is the color of the segment (antisegment) [tau_c, tau_cdag]:
+   * the weights are computed for the configuration without it, without modifying config.
+   */
+  std::vector<double> heat_bath_color_weights(configuration_t const &config, work_data_t const &wdata,
+                                              tau_t const &tau_c, tau_t const &tau_cdag, bool cut,
+                                              int reverse_color = -1);
+
+  // A color drawn with probability w[color] / sum_w (sum_w = sum(w) > 0)
+  int heat_bath_choice(std::vector<double> const &w, double sum_w, triqs::mc_tools::random_generator &rng);
+
+} // namespace triqs_ctseg::moves
@@ -16,8 +16,10 @@
 // Authors: Nikita Kavokine, Hao Lu, Olivier Parcollet, Nils Wentzell
 
 #include "insert_segment.hpp"
+#include "heat_bath_color.hpp"
 #include "../logs.hpp"
 #include <cmath>
+#include <numeric>
 
 namespace triqs_ctseg::moves {
 
@@ -25,6 +27,8 @@ namespace triqs_ctseg::moves {
 
     LOG("\n =================== ATTEMPT INSERT ================ \n");
 
+    if (wdata.heat_bath_color) return attempt_heat_bath();
+
     // ------------ Choice of segment --------------
     // Select insertion color
     color    = rng(config.n_color());
@@ -73,21 +77,40 @@ namespace triqs_ctseg::moves {
     double ln_trace_ratio = wdata.mu(color) * prop_seg.length(); // chemical potential
     // Overlaps
     for (auto c : range(config.n_color())) {
-      if (c != color) ln_trace_ratio += -wdata.U(color, c) * overlap(config.seglists[c], prop_seg);
-      if (wdata.has_Dt)
-        ln_trace_ratio += K_overlap(config.seglists[c], prop_seg.tau_c, prop_seg.tau_cdag, wdata.K, color, c);
+      if (c != color) ln_trace_ratio += -wdata.U(color, c) * overlap(config, c, prop_seg);
+    }
+    if (wdata.has_Dt) {
+      ln_trace_ratio += K_overlap(config, prop_seg.tau_c, prop_seg.tau_cdag, color, wdata);
+      ln_trace_ratio += -wdata.K(color, color, prop_seg.length()); // Correct double counting
     }
-    if (wdata.has_Dt)
-      ln_trace_ratio += -real(wdata.K(double(prop_seg.length()))(color, color)); // Correct double counting
     double trace_ratio = std::exp(ln_trace_ratio);
 
+    // ------------  Proposition ratio ------------
+
+    double current_number_intervals = std::max(long(1), long(sl.size()));
+    double future_number_segments   = sl.size() + 1;
+    // T direct  = 1 / current_number_intervals * 1/window_length^2 *
+    //                * (2 iif not empty as the proba to get the dt1, dt2 coupled is x 2)
+    // T inverse = 1 / future_number_segments
+    double prop_ratio =
+       (current_number_intervals * window_length * window_length / (sl.empty() ? 1 : 2)) / future_number_segments;
+    // Account for absence of time swapping when inserting into empty line.
+
+    // ------------  First stage of the two-stage acceptance ------------
+    // Without the det ratio: the move is rejected here with probability 1 - min(1, |trace_ratio * prop_ratio|)
+    // (the trace ratio can be negative, e.g. with Jperp: its sign is kept for the second stage)
+    if (wdata.delayed_acceptance and rng() >= std::abs(trace_ratio * prop_ratio)) {
+      LOG("Rejected by the trace and proposal ratios");
+      return 0;
+    }
+
     // ------------  Det ratio  ---------------
     //  insert tau_cdag as a line (first index) and tau_c as a column (second index).
     auto &bl     = wdata.block_number[color];
     auto &bl_idx = wdata.index_in_block[color];
     auto &D      = wdata.dets[bl];
     if (wdata.offdiag_Delta) {
-      if (cdag_in_det(prop_seg.tau_cdag, D) or c_in_det(prop_seg.tau_c, D)) {
+      if (wdata.cdag_times[bl].contains(prop_seg.tau_cdag) or wdata.c_times[bl].contains(prop_seg.tau_c)) {
         LOG("One of the proposed times already exists in another line of the same block. Rejecting.");
         return 0;
       }
@@ -96,20 +119,74 @@ namespace triqs_ctseg::moves {
                                   det_lower_bound_y(D, prop_seg.tau_c),    //
                                   {prop_seg.tau_cdag, bl_idx}, {prop_seg.tau_c, bl_idx});
 
+    LOG("trace_ratio  = {}, prop_ratio = {}, det_ratio = {}", trace_ratio, prop_ratio, det_ratio);
+
+    double prod = (wdata.delayed_acceptance ? (trace_ratio * prop_ratio < 0 ? -det_ratio : det_ratio)
+                                            : trace_ratio * det_ratio * prop_ratio);
+    det_sign    = (det_ratio > 0) ? 1.0 : -1.0;
+
+    return (std::isfinite(prod) ? prod : det_sign);
+  }
+
+  //--------------------------------------------------
+
+  double insert_segment::attempt_heat_bath() {
+
+    // ------------ Choice of segment --------------
+    // Choose the times uniformly in [0, beta[, then the color among those where the segment can be inserted,
+    // with a probability proportional to its trace ratio (heat bath)
+    auto tau_c    = tau_t::random(rng, tau_t::beta());
+    auto tau_cdag = tau_t::random(rng, tau_t::beta());
+    if (tau_c == tau_cdag) {
+      LOG("Insert_segment: generated equal times. Rejecting");
+      return 0;
+    }
+    prop_seg = segment_t{tau_c, tau_cdag};
+
+    auto w       = heat_bath_color_weights(config, wdata, tau_c, tau_cdag, false);
+    double sum_w = std::accumulate(w.begin(), w.end(), 0.0);
+    if (sum_w == 0) {
+      LOG("The segment cannot be inserted in any color.");
+      return 0;
+    }
+    color = heat_bath_choice(w, sum_w, rng);
+    LOG("Inserting segment with c at {}, cdag at {}, at color {}", prop_seg.tau_c, prop_seg.tau_cdag, color);
+
+    // ------------  Trace ratio  -------------
+    double future_number_segments = config.seglists[color].size() + 1;
+    double trace_ratio            = w[color] * future_number_segments;
+
     // ------------  Proposition ratio ------------
+    // T direct  = 1/beta^2 * w[color] / sum_w
+    // T inverse = 1 / n_color / future_number_segments
+    auto beta         = double(tau_t::beta());
+    double prop_ratio = beta * beta * sum_w / (w[color] * config.n_color() * future_number_segments);
+
+    // ------------  First stage of the two-stage acceptance ------------
+    if (wdata.delayed_acceptance and rng() >= std::abs(trace_ratio * prop_ratio)) {
+      LOG("Rejected by the trace and proposal ratios");
+      return 0;
+    }
 
-    double current_number_intervals = std::max(long(1), long(sl.size()));
-    double future_number_segments   = sl.size() + 1;
-    // T direct  = 1 / current_number_intervals * 1/window_length^2 *
-    //                * (2 iif not empty as the proba to get the dt1, dt2 coupled is x 2)
-    // T inverse = 1 / future_number_segments
-    double prop_ratio =
-       (current_number_intervals * window_length * window_length / (sl.empty() ? 1 : 2)) / future_number_segments;
-    // Account for absence of time swapping when inserting into empty line.
+    // ------------  Det ratio  ---------------
+    // Same as in attempt
+    auto &bl     = wdata.block_number[color];
+    auto &bl_idx = wdata.index_in_block[color];
+    auto &D      = wdata.dets[bl];
+    if (wdata.offdiag_Delta) {
+      if (wdata.cdag_times[bl].contains(prop_seg.tau_cdag) or wdata.c_times[bl].contains(prop_seg.tau_c)) {
+        LOG("One of the proposed times already exists in another line of the same block. Rejecting.");
+        return 0;
+      }
+    }
+    auto det_ratio = D.try_insert(det_lower_bound_x(D, prop_seg.tau_cdag), //
+                                  det_lower_bound_y(D, prop_seg.tau_c),    //
+                                  {prop_seg.tau_cdag, bl_idx}, {prop_seg.tau_c, bl_idx});
 
     LOG("trace_ratio  = {}, prop_ratio = {}, det_ratio = {}", trace_ratio, prop_ratio, det_ratio);
 
-    double prod = trace_ratio * det_ratio * prop_ratio;
+    double prod = (wdata.delayed_acceptance ? (trace_ratio * prop_ratio < 0 ? -det_ratio : det_ratio)
+                                            : trace_ratio * det_ratio * prop_ratio);
     det_sign    = (det_ratio > 0) ? 1.0 : -1.0;
 
     return (std::isfinite(prod) ? prod : det_sign);
@@ -121,22 +198,24 @@ namespace triqs_ctseg::moves {
 
     LOG("\n - - - - - ====> ACCEPT - - - - - - - - - - -\n");
 
-    double initial_sign = trace_sign(wdata);
-    LOG("Initial sign is {}. Initial configuration: {}", initial_sign, config);
+    LOG("Initial configuration: {}", config);
 
     // Insert the times into the det
-    wdata.dets[wdata.block_number[color]].complete_operation();
+    auto bl     = wdata.block_number[color];
+    auto bl_idx = int(wdata.index_in_block[color]);
+    wdata.dets[bl].complete_operation();
+    double sign_ratio = wdata.record_insert(bl, {prop_seg.tau_cdag, bl_idx}, {prop_seg.tau_c, bl_idx});
 
     // Insert the segment in an ordered list
     auto &sl = config.seglists[color];
     sl.insert(std::upper_bound(sl.begin(), sl.end(), prop_seg), prop_seg);
+    config.update_occupancy(color);
+    wdata.update_K_field(color, prop_seg.tau_c, prop_seg.tau_cdag, 1);
 
     // Check invariant
     if constexpr (print_logs or ctseg_debug) check_invariant(config, wdata);
 
-    double final_sign = trace_sign(wdata);
-    double sign_ratio = final_sign / initial_sign;
-    LOG("Final sign is {}", final_sign);
+    LOG("Sign ratio is {}", sign_ratio);
 
     if (sign_ratio * det_sign == -1.0) wdata.minus_sign = true;
 
@@ -86,16 +86,14 @@ namespace triqs_ctseg::moves {
 
     double ln_trace_ratio = (wdata.mu(dest_color) - wdata.mu(orig_color)) * spin_seg.length();
     if (wdata.has_Dt) {
-      for (auto [c, slist] : itertools::enumerate(config.seglists)) {
-        // "antisegment" - careful with order
-        ln_trace_ratio += K_overlap(slist, spin_seg.tau_cdag, spin_seg.tau_c, wdata.K, orig_color, c);
-        ln_trace_ratio += K_overlap(slist, spin_seg.tau_c, spin_seg.tau_cdag, wdata.K, dest_color, c);
-      }
+      // "antisegment" - careful with order
+      ln_trace_ratio += K_overlap(config, spin_seg.tau_cdag, spin_seg.tau_c, orig_color, wdata);
+      ln_trace_ratio += K_overlap(config, spin_seg.tau_c, spin_seg.tau_cdag, dest_color, wdata);
       // Add interactions of the inserted operators with themselves
-      auto Kl = wdata.K(double(spin_seg.length())); // matrix
-      ln_trace_ratio -= real(Kl(orig_color, orig_color));
-      ln_trace_ratio -= real(Kl(dest_color, dest_color));
-      ln_trace_ratio += 2 * real(Kl(orig_color, dest_color));
+      auto l = spin_seg.length();
+      ln_trace_ratio -= wdata.K(orig_color, orig_color, l);
+      ln_trace_ratio -= wdata.K(dest_color, dest_color, l);
+      ln_trace_ratio += 2 * wdata.K(orig_color, dest_color, l);
     }
     double trace_ratio = std::exp(ln_trace_ratio);
     trace_ratio *= -(real(wdata.Jperp(double(spin_seg.length()))(0, 0)) / 2);
@@ -145,6 +143,10 @@ namespace triqs_ctseg::moves {
 
     // Insert segment at destination
     dsl.insert(std::upper_bound(begin(dsl), end(dsl), spin_seg), spin_seg);
+    config.update_occupancy(orig_color);
+    config.update_occupancy(dest_color);
+    wdata.update_K_field(orig_color, spin_seg.tau_cdag, spin_seg.tau_c, 1);
+    wdata.update_K_field(dest_color, spin_seg.tau_c, spin_seg.tau_cdag, 1);
 
     // Insert Jperp line
     auto &jl = config.Jperp_list;
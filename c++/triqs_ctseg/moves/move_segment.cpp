@@ -34,37 +34,31 @@ namespace triqs_ctseg::moves {
     if (dest_color >= origin_color) ++dest_color; // little trick to select another color
     LOG("Moving to color {}", dest_color);
 
-    // Reject if colors within the same block because no appropriate det_manip function (FIXME)
+    // If the colors are within the same block, the row and the column of the segment are changed in the det
     auto const &origin_bl      = wdata.block_number[origin_color];
     auto const &destination_bl = wdata.block_number[dest_color];
     auto const &idx_dest       = wdata.index_in_block[dest_color];
-    if (origin_bl == destination_bl) {
-      LOG("Reject: colors are within the same block.");
-      return 0;
-    }
+    same_block                 = (origin_bl == destination_bl);
 
     // Do we want to move an antisegment ?
+    // The antisegments are read through a view of the flipped configuration: no copy of the seglists.
     flipped = (rng(2) == 0);
+    if (flipped) LOG("Moving antisegment.");
 
-    if (flipped) {
-      // if we want to move an antisegment, we simply flip the configuration
-      sl  = flip(config.seglists[origin_color]);
-      dsl = flip(config.seglists[dest_color]);
-      LOG("Moving antisegment.");
-    } else {
-      sl  = config.seglists[origin_color];
-      dsl = config.seglists[dest_color];
-    }
+    auto const &sl  = config.seglists[origin_color];
+    auto const &dsl = config.seglists[dest_color];
+    long n_origin   = flipped ? flipped_view_t{sl}.size() : long(sl.size());
+    long n_dest     = flipped ? flipped_view_t{dsl}.size() : long(dsl.size());
 
     // If color has no segments, nothing to move
-    if (sl.empty()) {
+    if (n_origin == 0) {
       LOG("Nothing to move!");
       return 0;
     }
 
     // Select segment to move
-    origin_index   = rng(sl.size());
-    origin_segment = sl[origin_index];
+    origin_index   = rng(n_origin);
+    origin_segment = flipped ? flipped_view_t{sl}[origin_index] : sl[origin_index];
     LOG("Moving segment at position {}", origin_index);
 
     // Reject if the segment has spin lines attached
@@ -74,24 +68,21 @@ namespace triqs_ctseg::moves {
     }
 
     // Reject if chosen segment overlaps with destination color
-    if (not is_insertable_into(origin_segment, dsl)) {
+    // (for an antisegment : if it is not inside a segment of the destination color)
+    if (not(flipped ? is_inside(origin_segment, dsl) : is_insertable_into(origin_segment, dsl))) {
       LOG("Space is occupied in destination color.");
       return 0;
     }
 
-    // Find where origin segment should be inserted in destination color
-    dest_index = std::upper_bound(dsl.begin(), dsl.end(), origin_segment) - dsl.cbegin();
-    LOG("Moving to position {}", dest_index);
-
     // ------------  Trace ratio  -------------
 
     double ln_trace_ratio =
        (flipped ? -1 : 1) * (wdata.mu(dest_color) - wdata.mu(origin_color)) * double(origin_segment.length());
 
-    for (auto const &[c, slist] : itertools::enumerate(config.seglists)) {
+    for (int c = 0; c < config.n_color(); ++c) {
       if (c != dest_color && c != origin_color) {
-        ln_trace_ratio += -wdata.U(dest_color, c) * overlap(slist, origin_segment) * (flipped ? -1 : 1);
-        ln_trace_ratio -= -wdata.U(origin_color, c) * overlap(slist, origin_segment) * (flipped ? -1 : 1);
+        ln_trace_ratio += -wdata.U(dest_color, c) * overlap(config, c, origin_segment) * (flipped ? -1 : 1);
+        ln_trace_ratio -= -wdata.U(origin_color, c) * overlap(config, c, origin_segment) * (flipped ? -1 : 1);
       }
     }
 
@@ -100,18 +91,28 @@ namespace triqs_ctseg::moves {
       auto tau_cdag = origin_segment.tau_cdag;
       if (flipped) std::swap(tau_c, tau_cdag);
 
-      for (auto const &[c, slist] : itertools::enumerate(config.seglists)) {
-        ln_trace_ratio += K_overlap(slist, tau_c, tau_cdag, wdata.K, dest_color, c);
-        ln_trace_ratio -= K_overlap(slist, tau_c, tau_cdag, wdata.K, origin_color, c);
-      }
+      ln_trace_ratio += K_overlap(config, tau_c, tau_cdag, dest_color, wdata);
+      ln_trace_ratio -= K_overlap(config, tau_c, tau_cdag, origin_color, wdata);
       // Correct double counting
-      auto Kl = wdata.K(double(origin_segment.length())); // matrix
-      ln_trace_ratio -= real(Kl(origin_color, origin_color));
-      ln_trace_ratio -= real(Kl(dest_color, dest_color));
-      ln_trace_ratio += 2 * real(Kl(origin_color, dest_color));
+      auto l = origin_segment.length();
+      ln_trace_ratio -= wdata.K(origin_color, origin_color, l);
+      ln_trace_ratio -= wdata.K(dest_color, dest_color, l);
+      ln_trace_ratio += 2 * wdata.K(origin_color, dest_color, l);
     }
     double trace_ratio = std::exp(ln_trace_ratio);
 
+    // ------------  Proposition ratio -----------
+
+    double prop_ratio = double(n_origin) / (n_dest + 1);
+
+    // ------------  First stage of the two-stage acceptance ------------
+    // Without the det ratio: the move is rejected here with probability 1 - min(1, |trace_ratio * prop_ratio|)
+    // (the trace ratio can be negative, e.g. with Jperp: its sign is kept for the second stage)
+    if (wdata.delayed_acceptance and rng() >= std::abs(trace_ratio * prop_ratio)) {
+      LOG("Rejected by the trace and proposal ratios");
+      return 0;
+    }
+
     // ------------  Det ratio  ---------------
     // Times are ordered in det. We insert tau_cdag as a line (first index) and tau_c as a column.
     // c and cdag are inverted if we flip
@@ -119,24 +120,28 @@ namespace triqs_ctseg::moves {
     auto seg         = (flipped ? flip(origin_segment) : origin_segment);
     auto &D_dest     = wdata.dets[destination_bl];
     auto &D_orig     = wdata.dets[origin_bl];
-    if (wdata.offdiag_Delta) {
-      if (cdag_in_det(seg.tau_cdag, D_dest) or c_in_det(seg.tau_c, D_dest)) {
+    if (wdata.offdiag_Delta and not same_block) {
+      if (wdata.cdag_times[destination_bl].contains(seg.tau_cdag)
+          or wdata.c_times[destination_bl].contains(seg.tau_c)) {
         LOG("Proposed times already exist in destination block.");
         return 0;
       }
     }
-    if (not is_full_line(origin_segment))
-      det_ratio = D_dest.try_insert(det_lower_bound_x(D_dest, seg.tau_cdag), det_lower_bound_y(D_dest, seg.tau_c),
-                                    {seg.tau_cdag, idx_dest}, {seg.tau_c, idx_dest})
-         * D_orig.try_remove(det_lower_bound_x(D_orig, seg.tau_cdag), det_lower_bound_y(D_orig, seg.tau_c));
-
-    // ------------  Proposition ratio -----------
-
-    double prop_ratio = double(sl.size()) / (dsl.size() + 1);
+    if (not is_full_line(origin_segment)) {
+      if (same_block)
+        det_ratio = D_orig.try_change_col_row(det_lower_bound_x(D_orig, seg.tau_cdag),
+                                              det_lower_bound_y(D_orig, seg.tau_c), {seg.tau_cdag, idx_dest},
+                                              {seg.tau_c, idx_dest});
+      else
+        det_ratio = D_dest.try_insert(det_lower_bound_x(D_dest, seg.tau_cdag), det_lower_bound_y(D_dest, seg.tau_c),
+                                      {seg.tau_cdag, idx_dest}, {seg.tau_c, idx_dest})
+           * D_orig.try_remove(det_lower_bound_x(D_orig, seg.tau_cdag), det_lower_bound_y(D_orig, seg.tau_c));
+    }
 
     LOG("trace_ratio  = {}, prop_ratio = {}, det_ratio = {}", trace_ratio, prop_ratio, det_ratio);
 
-    double prod = trace_ratio * det_ratio * prop_ratio;
+    double prod = (wdata.delayed_acceptance ? (trace_ratio * prop_ratio < 0 ? -det_ratio : det_ratio)
+                                            : trace_ratio * det_ratio * prop_ratio);
     det_sign    = (det_ratio > 0) ? 1.0 : -1.0;
     return (std::isfinite(prod) ? prod : det_sign);
   }
@@ -147,33 +152,42 @@ namespace triqs_ctseg::moves {
 
     LOG("\n - - - - - ====> ACCEPT - - - - - - - - - - -\n");
 
-    double initial_sign = trace_sign(wdata);
-    LOG("Initial sign is {}. Initial configuration: {}", initial_sign, config);
+    LOG("Initial configuration: {}", config);
+
+    // Operators of the moved segment (c and cdag are swapped if flipped)
+    auto tau_c    = (flipped ? origin_segment.tau_cdag : origin_segment.tau_c);
+    auto tau_cdag = (flipped ? origin_segment.tau_c : origin_segment.tau_cdag);
 
     // Update the dets
     auto const &origin_bl      = wdata.block_number[origin_color];
     auto const &destination_bl = wdata.block_number[dest_color];
     wdata.dets[origin_bl].complete_operation();
-    wdata.dets[destination_bl].complete_operation();
-
-    // Add the segment at destination
-    dsl.insert(begin(dsl) + dest_index, origin_segment);
-
-    // Remove the segment at origin
-    sl.erase(begin(sl) + origin_index);
+    if (not same_block) wdata.dets[destination_bl].complete_operation();
+    double sign_ratio = 1;
+    if (not is_full_line(origin_segment)) {
+      auto idx_orig = int(wdata.index_in_block[origin_color]);
+      auto idx_dest = int(wdata.index_in_block[dest_color]);
+      sign_ratio    = wdata.record_remove(origin_bl, {tau_cdag, idx_orig}, {tau_c, idx_orig});
+      sign_ratio *= wdata.record_insert(destination_bl, {tau_cdag, idx_dest}, {tau_c, idx_dest});
+    }
 
+    auto &sl  = config.seglists[origin_color];
+    auto &dsl = config.seglists[dest_color];
     if (flipped) {
-      config.seglists[origin_color] = flip(sl);
-      config.seglists[dest_color]   = flip(dsl);
+      // Remove the antisegment at origin, insert it at destination
+      fill_antisegment(sl, origin_index);
+      cut_antisegment(dsl, origin_segment);
     } else {
-      config.seglists[origin_color] = std::move(sl);
-      config.seglists[dest_color]   = std::move(dsl);
+      dsl.insert(std::upper_bound(dsl.begin(), dsl.end(), origin_segment), origin_segment);
+      sl.erase(begin(sl) + origin_index);
     }
-    // WARNING : do not use sl, dsl AFTER !
+    config.update_occupancy(origin_color);
+    config.update_occupancy(dest_color);
+
+    wdata.update_K_field(origin_color, tau_c, tau_cdag, -1);
+    wdata.update_K_field(dest_color, tau_c, tau_cdag, 1);
 
-    double final_sign = trace_sign(wdata);
-    double sign_ratio = final_sign / initial_sign;
-    LOG("Final sign is {}", final_sign);
+    LOG("Sign ratio is {}", sign_ratio);
 
     // Check invariant
     if constexpr (print_logs or ctseg_debug) check_invariant(config, wdata);
@@ -191,7 +205,7 @@ namespace triqs_ctseg::moves {
     auto const &origin_bl      = wdata.block_number[origin_color];
     auto const &destination_bl = wdata.block_number[dest_color];
     wdata.dets[origin_bl].reject_last_try();
-    wdata.dets[destination_bl].reject_last_try();
+    if (not same_block) wdata.dets[destination_bl].reject_last_try();
   }
 
 } // namespace triqs_ctseg::moves
@@ -28,12 +28,12 @@ namespace triqs_ctseg::moves {
     triqs::mc_tools::random_generator &rng;
 
     // Internal data
-    bool flipped; // whether we flip an antisegment
+    bool flipped;    // whether we flip an antisegment
+    bool same_block; // whether the origin and destination colors are in the same det
     int origin_color, dest_color;
     segment_t origin_segment;
-    long origin_index, dest_index;
+    long origin_index;
     double det_sign;
-    std::vector<segment_t> sl, dsl;
 
     public:
     move_segment(work_data_t &data_, configuration_t &config_, triqs::mc_tools::random_generator &rng_)
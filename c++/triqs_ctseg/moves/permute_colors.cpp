@@ -0,0 +1,218 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <algorithm>
+#include "permute_colors.hpp"
+#include "../logs.hpp"
+
+namespace triqs_ctseg::moves {
+
+  permute_colors::permute_colors(work_data_t &data_, configuration_t &config_,
+                                 triqs::mc_tools::random_generator &rng_,
+                                 std::vector<std::vector<long>> const &color_permutations)
+     : wdata(data_), config(config_), rng(rng_) {
+
+    long n_color = wdata.n_color;
+    long n_dets  = long(wdata.dets.size());
+    auto delta   = [this](long c1, long c2) {
+      return wdata.Delta[wdata.gf_block_number[c1]].data()(range::all, wdata.gf_index_in_block[c1],
+                                                             wdata.gf_index_in_block[c2]);
+    };
+
+    for (auto const &[k, color] : itertools::enumerate(color_permutations)) {
+      // A permutation of the colors ...
+      ALWAYS_EXPECTS((long(color.size()) == n_color), "Error: color_permutations: permutation {} has {} colors, not {}",
+                     k, color.size(), n_color);
+      auto inverse = std::vector<long>(n_color, -1);
+      for (auto c : range(n_color)) {
+        ALWAYS_EXPECTS((color[c] >= 0 and color[c] < n_color and inverse[color[c]] == -1),
+                       "Error: color_permutations: permutation {} is not a permutation of the colors", k);
+        inverse[color[c]] = c;
+      }
+      // ... which is a symmetry of the trace
+      for (auto a : range(n_color)) {
+        ALWAYS_EXPECTS((std::abs(wdata.mu(color[a]) - wdata.mu(a)) < 1.e-13),
+                       "Error: color_permutations: mu is not symmetric under permutation {}", k);
+        for (auto b : range(n_color)) {
+          ALWAYS_EXPECTS((std::abs(wdata.U(color[a], color[b]) - wdata.U(a, b)) < 1.e-13),
+                         "Error: color_permutations: U is not symmetric under permutation {}", k);
+          if (wdata.has_Dt)
+            ALWAYS_EXPECTS((max_element(abs(wdata.D0t.data()(range::all, color[a], color[b])
+                                            - wdata.D0t.data()(range::all, a, b)))
+                            < 1.e-13),
+                           "Error: color_permutations: D0(tau) is not symmetric under permutation {}", k);
+        }
+      }
+
+      // Det receiving the operators of the det source[bl] as they are, or -1: the permutation maps the colors
+      // of source[bl] onto the colors of bl, with the same indices, and their Delta(tau) are equal.
+      auto source = std::vector<long>(n_dets, -1);
+      for (auto bl : range(n_dets)) {
+        auto const &colors = wdata.det_colors[bl];
+        long src           = wdata.block_number[inverse[colors[0]]];
+        bool same          = (wdata.det_colors[src].size() == colors.size());
+        for (auto const &[idx, c] : itertools::enumerate(colors)) {
+          same = same and (wdata.block_number[inverse[c]] == src) and (wdata.index_in_block[inverse[c]] == idx);
+          for (auto c2 : colors)
+            same = same and (max_element(abs(delta(inverse[c], inverse[c2]) - delta(c, c2))) < 1.e-13);
+        }
+        if (same) source[bl] = src;
+      }
+
+      // The cycles of source are exchanged, the other dets are refilled
+      auto p = permutation_t{color, inverse, {}, {}};
+      for (auto bl : range(n_dets)) {
+        auto cycle = std::vector<long>{bl};
+        long b     = source[bl];
+        while (b >= 0 and b != bl) {
+          cycle.push_back(b);
+          b = source[b];
+        }
+        if (b < 0)
+          p.refilled_dets.push_back(bl);
+        else if (bl == *std::min_element(cycle.begin(), cycle.end())) // Each cycle once
+          for (long i = 0; i + 1 < long(cycle.size()); ++i) p.det_swaps.emplace_back(cycle[i], cycle[i + 1]);
+      }
+      permutations.push_back(std::move(p));
+    }
+
+    // Detailed balance: the inverse of a permutation must also be proposed
+    for (auto const &p : permutations)
+      ALWAYS_EXPECTS(std::any_of(permutations.begin(), permutations.end(),
+                                 [&p](auto const &q) { return q.color == p.inverse; }),
+                     "Error: color_permutations: the inverse of each permutation must be in the list");
+  }
+
+  //--------------------------------------------------
+
+  double permute_colors::attempt() {
+
+    LOG("\n =================== ATTEMPT PERMUTE COLORS ================ \n");
+
+    if (not config.Jperp_list.empty()) {
+      LOG("Configuration has spin lines: cannot permute colors.");
+      return 0;
+    }
+
+    // ------------ Choice of permutation --------------
+    perm_idx      = rng(permutations.size());
+    auto const &P = permutations[perm_idx];
+    LOG("Permutation {}", perm_idx);
+
+    // ------------  Trace ratio  -------------
+    // The permutation is a symmetry of the trace: the ratio is 1.
+
+    // ------------  Det ratio  ---------------
+    // The exchanged dets do not change the product of the dets. The other dets are refilled with the operators
+    // of the colors they receive, in time order.
+    double det_ratio = 1;
+    new_x.resize(P.refilled_dets.size());
+    new_y.resize(P.refilled_dets.size());
+    auto by_time   = [](auto const &a, auto const &b) { return a.first < b.first; };
+    auto same_time = [](auto const &a, auto const &b) { return a.first == b.first; };
+    for (auto const &[k, bl] : itertools::enumerate(P.refilled_dets)) {
+      auto &x = new_x[k];
+      auto &y = new_y[k];
+      x.clear();
+      y.clear();
+      for (auto const &[idx, c] : itertools::enumerate(wdata.det_colors[bl])) {
+        for (auto const &seg : config.seglists[P.inverse[c]]) {
+          if (is_full_line(seg)) continue;
+          x.emplace_back(seg.tau_cdag, int(idx));
+          y.emplace_back(seg.tau_c, int(idx));
+        }
+      }
+      std::sort(x.begin(), x.end(), by_time);
+      std::sort(y.begin(), y.end(), by_time);
+      if (std::adjacent_find(x.begin(), x.end(), same_time) != x.end()
+          or std::adjacent_find(y.begin(), y.end(), same_time) != y.end()) {
+        LOG("Two operators of the same det would have the same time. Rejecting.");
+        return 0;
+      }
+      det_ratio *= wdata.dets[bl].try_refill(x, y);
+    }
+
+    // ------------  Proposition ratio ------------
+    // The inverse permutation is proposed with the same probability
+    double prop_ratio = 1;
+
+    LOG("prop_ratio = {}, det_ratio = {}", prop_ratio, det_ratio);
+
+    det_sign    = (det_ratio > 0) ? 1.0 : -1.0;
+    double prod = det_ratio * prop_ratio;
+    return (std::isfinite(prod) ? prod : det_sign);
+  }
+
+  //--------------------------------------------------
+
+  double permute_colors::accept() {
+
+    LOG("\n - - - - - ====> ACCEPT - - - - - - - - - - -\n");
+
+    LOG("Initial configuration: {}", config);
+
+    auto const &P = permutations[perm_idx];
+
+    // Update the dets, with the sign trackers and time sets
+    double initial_sign = wdata.tracked_trace_sign();
+    for (auto const &[b1, b2] : P.det_swaps) {
+      std::swap(wdata.dets[b1], wdata.dets[b2]);
+      std::swap(wdata.sign_trackers[b1], wdata.sign_trackers[b2]);
+      if (wdata.offdiag_Delta) {
+        std::swap(wdata.c_times[b1], wdata.c_times[b2]);
+        std::swap(wdata.cdag_times[b1], wdata.cdag_times[b2]);
+      }
+    }
+    for (auto const &[k, bl] : itertools::enumerate(P.refilled_dets)) {
+      wdata.dets[bl].complete_operation();
+      wdata.sign_trackers[bl] = sign_tracker_t{int(wdata.det_colors[bl].size())};
+      if (wdata.offdiag_Delta) {
+        wdata.c_times[bl]    = time_set_t{};
+        wdata.cdag_times[bl] = time_set_t{};
+      }
+      for (auto i : range(new_x[k].size())) wdata.record_insert(bl, new_x[k][i], new_y[k][i]);
+    }
+    double sign_ratio = wdata.tracked_trace_sign() / initial_sign;
+
+    // Permute the seglists
+    auto seglists  = config.seglists;
+    auto occupancy = config.occupancy;
+    for (auto c : range(config.n_color())) {
+      config.seglists[P.color[c]]  = std::move(seglists[c]);
+      config.occupancy[P.color[c]] = std::move(occupancy[c]);
+    }
+    if (wdata.use_K_field) wdata.K_field.reset(wdata.K_field_table(), config.seglists);
+
+    LOG("Sign ratio is {}", sign_ratio);
+
+    // Check invariant
+    if constexpr (print_logs or ctseg_debug) check_invariant(config, wdata);
+
+    if (sign_ratio * det_sign == -1.0) wdata.minus_sign = true;
+
+    LOG("Configuration is {}", config);
+
+    return sign_ratio;
+  }
+
+  //--------------------------------------------------
+  void permute_colors::reject() {
+    LOG("\n - - - - - ====> REJECT - - - - - - - - - - -\n");
+    for (auto bl : permutations[perm_idx].refilled_dets) wdata.dets[bl].reject_last_try();
+  }
+
+} // namespace triqs_ctseg::moves
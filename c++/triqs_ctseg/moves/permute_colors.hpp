@@ -0,0 +1,61 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#pragma once
+#include "../work_data.hpp"
+#include "../configuration.hpp"
+#include "../invariants.hpp"
+
+namespace triqs_ctseg::moves {
+
+  /**
+   * Global move: permute the colors of the whole configuration, e.g. swap the up and down seglists.
+   *
+   * The permutations are given by the user, and must be symmetries of mu, U and D0(tau), so that the trace is
+   * unchanged. Delta(tau) need not be symmetric: the dets are refilled from scratch (O(N^3)), except for the cycles
+   * of dets which the permutation maps one-to-one onto dets with the same Delta(tau), which are just exchanged.
+   * Not attempted if there are spin lines. Meant to be proposed at a low rate (see move_weights).
+   */
+  class permute_colors {
+    work_data_t &wdata;
+    configuration_t &config;
+    triqs::mc_tools::random_generator &rng;
+
+    // A permutation, with new color color[c] for the color c, and what it does to the dets:
+    // the exchanges of the dets (det_swaps) and the dets to be refilled
+    struct permutation_t {
+      std::vector<long> color, inverse;
+      std::vector<std::pair<long, long>> det_swaps;
+      std::vector<long> refilled_dets;
+    };
+    std::vector<permutation_t> permutations;
+
+    // Internal data
+    long perm_idx = 0;
+    std::vector<std::vector<std::pair<tau_t, int>>> new_x, new_y; // New operators of the refilled dets
+    double det_sign;
+
+    public:
+    permute_colors(work_data_t &data_, configuration_t &config_, triqs::mc_tools::random_generator &rng_,
+                   std::vector<std::vector<long>> const &color_permutations);
+    // ------------------
+    double attempt();
+    double accept();
+    void reject();
+  };
+
+} // namespace triqs_ctseg::moves
@@ -16,7 +16,9 @@
 // Authors: Nikita Kavokine, Hao Lu, Olivier Parcollet, Nils Wentzell
 
 #include "regroup_segment.hpp"
+#include "heat_bath_color.hpp"
 #include "../logs.hpp"
+#include <numeric>
 
 namespace triqs_ctseg::moves {
 
@@ -66,24 +68,15 @@ namespace triqs_ctseg::moves {
     double ln_trace_ratio = wdata.mu(color) * inserted_seg.length();
 
     for (auto c : range(config.n_color())) {
-      if (c != color) { ln_trace_ratio += -wdata.U(color, c) * overlap(config.seglists[c], inserted_seg); }
-      if (wdata.has_Dt) {
-        ln_trace_ratio -= K_overlap(config.seglists[c], right_seg.tau_c, left_seg.tau_cdag, wdata.K, color, c);
-      }
+      if (c != color) { ln_trace_ratio += -wdata.U(color, c) * overlap(config, c, inserted_seg); }
+    }
+    if (wdata.has_Dt) {
+      ln_trace_ratio -= K_overlap(config, right_seg.tau_c, left_seg.tau_cdag, color, wdata);
+      ln_trace_ratio -= wdata.K(color, color, right_seg.tau_c - left_seg.tau_cdag); // Correct double counting
     }
-    if (wdata.has_Dt)
-      ln_trace_ratio -=
-         real(wdata.K(double(right_seg.tau_c - left_seg.tau_cdag))(color, color)); // Correct double counting
 
     double trace_ratio = std::exp(ln_trace_ratio);
 
-    // ------------  Det ratio  ---------------
-    // We remove a cdag (first index) from the left segment and a c (second index) from the right segment.
-    auto bl        = wdata.block_number[color];
-    auto &D        = wdata.dets[bl];
-    auto det_ratio = D.try_remove(det_lower_bound_x(D, left_seg.tau_cdag), //
-                                  det_lower_bound_y(D, right_seg.tau_c));
-
     // ------------  Proposition ratio ------------
 
     double future_number_segments   = making_full_line ? 1 : sl.size() - 1;
@@ -96,10 +89,35 @@ namespace triqs_ctseg::moves {
     double prop_ratio =
        current_number_intervals / (future_number_segments * new_seg_len * new_seg_len / (making_full_line ? 1 : 2));
 
+    if (wdata.heat_bath_color) {
+      // T inverse = 1/beta^2 * w[color] / sum(w): heat-bath choice of the color in split_segment
+      // T direct  = 1 / n_color / current_number_intervals
+      auto w     = heat_bath_color_weights(config, wdata, right_seg.tau_c, left_seg.tau_cdag, true, color);
+      auto beta  = double(tau_t::beta());
+      prop_ratio = config.n_color() * current_number_intervals * w[color]
+         / (beta * beta * std::accumulate(w.begin(), w.end(), 0.0));
+    }
+
+    // ------------  First stage of the two-stage acceptance ------------
+    // Without the det ratio: the move is rejected here with probability 1 - min(1, |trace_ratio * prop_ratio|)
+    // (the trace ratio can be negative, e.g. with Jperp: its sign is kept for the second stage)
+    if (wdata.delayed_acceptance and rng() >= std::abs(trace_ratio * prop_ratio)) {
+      LOG("Rejected by the trace and proposal ratios");
+      return 0;
+    }
+
+    // ------------  Det ratio  ---------------
+    // We remove a cdag (first index) from the left segment and a c (second index) from the right segment.
+    auto bl        = wdata.block_number[color];
+    auto &D        = wdata.dets[bl];
+    auto det_ratio = D.try_remove(det_lower_bound_x(D, left_seg.tau_cdag), //
+                                  det_lower_bound_y(D, right_seg.tau_c));
+
     LOG("trace_ratio  = {}, prop_ratio = {}, det_ratio = {}", trace_ratio, prop_ratio, det_ratio);
 
     det_sign    = (det_ratio > 0) ? 1.0 : -1.0;
-    double prod = trace_ratio * det_ratio * prop_ratio;
+    double prod = (wdata.delayed_acceptance ? (trace_ratio * prop_ratio < 0 ? -det_ratio : det_ratio)
+                                            : trace_ratio * det_ratio * prop_ratio);
 
     return (std::isfinite(prod)) ? prod : det_sign;
   }
@@ -110,11 +128,13 @@ namespace triqs_ctseg::moves {
 
     LOG("\n - - - - - ====> ACCEPT - - - - - - - - - - -\n");
 
-    double initial_sign = trace_sign(wdata);
-    LOG("Initial sign is {}. Initial configuration: {}", initial_sign, config);
+    LOG("Initial configuration: {}", config);
 
     // Update the dets
-    wdata.dets[wdata.block_number[color]].complete_operation();
+    auto bl     = wdata.block_number[color];
+    auto bl_idx = int(wdata.index_in_block[color]);
+    wdata.dets[bl].complete_operation();
+    double sign_ratio = wdata.record_remove(bl, {left_seg.tau_cdag, bl_idx}, {right_seg.tau_c, bl_idx});
 
     // Regroup segments
     auto &sl = config.seglists[color];
@@ -126,10 +146,10 @@ namespace triqs_ctseg::moves {
       // Remove the right segment
       sl.erase(sl.begin() + right_seg_idx);
     }
+    config.update_occupancy(color);
+    wdata.update_K_field(color, right_seg.tau_c, left_seg.tau_cdag, -1);
 
-    double final_sign = trace_sign(wdata);
-    double sign_ratio = final_sign / initial_sign;
-    LOG("Final sign is {}", final_sign);
+    LOG("Sign ratio is {}", sign_ratio);
 
     // Check invariant
     if constexpr (print_logs or ctseg_debug) check_invariant(config, wdata);
@@ -16,7 +16,9 @@
 // Authors: Nikita Kavokine, Hao Lu, Olivier Parcollet, Nils Wentzell
 
 #include "remove_segment.hpp"
+#include "heat_bath_color.hpp"
 #include "../logs.hpp"
+#include <numeric>
 
 namespace triqs_ctseg::moves {
 
@@ -55,21 +57,15 @@ namespace triqs_ctseg::moves {
     // FIXME : pull it out ?
     double ln_trace_ratio = -wdata.mu(color) * prop_seg.length();
     for (auto c : range(config.n_color())) {
-      if (c != color) { ln_trace_ratio -= -wdata.U(color, c) * overlap(config.seglists[c], prop_seg); }
-      if (wdata.has_Dt)
-        ln_trace_ratio -= K_overlap(config.seglists[c], prop_seg.tau_c, prop_seg.tau_cdag, wdata.K, color, c);
+      if (c != color) { ln_trace_ratio -= -wdata.U(color, c) * overlap(config, c, prop_seg); }
+    }
+    if (wdata.has_Dt) {
+      ln_trace_ratio -= K_overlap(config, prop_seg.tau_c, prop_seg.tau_cdag, color, wdata);
+      ln_trace_ratio -= wdata.K(color, color, prop_seg.length());
     }
-    if (wdata.has_Dt) ln_trace_ratio -= real(wdata.K(double(prop_seg.length()))(color, color));
 
     double trace_ratio = std::exp(ln_trace_ratio);
 
-    // ------------  Det ratio  ---------------
-    // same code as in insert. In Insert, it is a true bound, does not insert at same time
-    auto bl        = wdata.block_number[color];
-    auto &D        = wdata.dets[bl];
-    auto det_ratio = D.try_remove(det_lower_bound_x(D, prop_seg.tau_cdag), //
-                                  det_lower_bound_y(D, prop_seg.tau_c));
-
     // ------------  Proposition ratio ------------
 
     double current_number_segments = sl.size();
@@ -86,10 +82,36 @@ namespace triqs_ctseg::moves {
 
     double prop_ratio = current_number_segments
        / (future_number_intervals * window_length * window_length / (current_number_segments == 1 ? 1 : 2));
+
+    if (wdata.heat_bath_color) {
+      // T inverse = 1/beta^2 * w[color] / sum(w): heat-bath choice of the color in insert_segment
+      // T direct  = 1 / n_color / current_number_segments
+      auto w     = heat_bath_color_weights(config, wdata, prop_seg.tau_c, prop_seg.tau_cdag, false, color);
+      auto beta  = double(tau_t::beta());
+      prop_ratio = config.n_color() * current_number_segments * w[color]
+         / (beta * beta * std::accumulate(w.begin(), w.end(), 0.0));
+    }
+
+    // ------------  First stage of the two-stage acceptance ------------
+    // Without the det ratio: the move is rejected here with probability 1 - min(1, |trace_ratio * prop_ratio|)
+    // (the trace ratio can be negative, e.g. with Jperp: its sign is kept for the second stage)
+    if (wdata.delayed_acceptance and rng() >= std::abs(trace_ratio * prop_ratio)) {
+      LOG("Rejected by the trace and proposal ratios");
+      return 0;
+    }
+
+    // ------------  Det ratio  ---------------
+    // same code as in insert. In Insert, it is a true bound, does not insert at same time
+    auto bl        = wdata.block_number[color];
+    auto &D        = wdata.dets[bl];
+    auto det_ratio = D.try_remove(det_lower_bound_x(D, prop_seg.tau_cdag), //
+                                  det_lower_bound_y(D, prop_seg.tau_c));
+
     LOG("trace_ratio  = {}, prop_ratio = {}, det_ratio = {}", trace_ratio, prop_ratio, det_ratio);
 
     det_sign    = (det_ratio > 0) ? 1.0 : -1.0;
-    double prod = trace_ratio * det_ratio * prop_ratio;
+    double prod = (wdata.delayed_acceptance ? (trace_ratio * prop_ratio < 0 ? -det_ratio : det_ratio)
+                                            : trace_ratio * det_ratio * prop_ratio);
 
     return (std::isfinite(prod)) ? prod : det_sign;
   }
@@ -100,19 +122,21 @@ namespace triqs_ctseg::moves {
 
     LOG("\n - - - - - ====> ACCEPT - - - - - - - - - - -\n");
 
-    double initial_sign = trace_sign(wdata);
-    LOG("Initial sign is {}. Initial configuration: {}", initial_sign, config);
+    LOG("Initial configuration: {}", config);
 
     // Update the dets
-    wdata.dets[wdata.block_number[color]].complete_operation();
+    auto bl     = wdata.block_number[color];
+    auto bl_idx = int(wdata.index_in_block[color]);
+    wdata.dets[bl].complete_operation();
+    double sign_ratio = wdata.record_remove(bl, {prop_seg.tau_cdag, bl_idx}, {prop_seg.tau_c, bl_idx});
 
     auto &sl = config.seglists[color];
     // Remove the segment
     sl.erase(sl.begin() + prop_seg_idx);
+    config.update_occupancy(color);
+    wdata.update_K_field(color, prop_seg.tau_c, prop_seg.tau_cdag, -1);
 
-    double final_sign = trace_sign(wdata);
-    double sign_ratio = initial_sign / final_sign;
-    LOG("Final sign is {}", final_sign);
+    LOG("Sign ratio is {}", sign_ratio);
 
     // Check invariant
     if constexpr (print_logs or ctseg_debug) check_invariant(config, wdata);
@@ -103,15 +103,13 @@ namespace triqs_ctseg::moves {
 
     double ln_trace_ratio = (wdata.mu(dest_color) - wdata.mu(orig_color)) * spin_seg.length();
     if (wdata.has_Dt) {
-      for (auto c : range(config.n_color())) {
-        ln_trace_ratio -= K_overlap(config.seglists[c], spin_seg.tau_c, spin_seg.tau_cdag, wdata.K, orig_color, c);
-        // "antisegment" - careful with order
-        ln_trace_ratio -= K_overlap(config.seglists[c], spin_seg.tau_cdag, spin_seg.tau_c, wdata.K, dest_color, c);
-      }
+      ln_trace_ratio -= K_overlap(config, spin_seg.tau_c, spin_seg.tau_cdag, orig_color, wdata);
+      // "antisegment" - careful with order
+      ln_trace_ratio -= K_overlap(config, spin_seg.tau_cdag, spin_seg.tau_c, dest_color, wdata);
       // Correct for the interactions of the removed operators with themselves
-      ln_trace_ratio -= real(wdata.K(double(spin_seg.length()))(orig_color, orig_color));
-      ln_trace_ratio -= real(wdata.K(double(spin_seg.length()))(dest_color, dest_color));
-      ln_trace_ratio += 2 * real(wdata.K(double(spin_seg.length()))(orig_color, dest_color));
+      ln_trace_ratio -= wdata.K(orig_color, orig_color, spin_seg.length());
+      ln_trace_ratio -= wdata.K(dest_color, dest_color, spin_seg.length());
+      ln_trace_ratio += 2 * wdata.K(orig_color, dest_color, spin_seg.length());
     }
     double trace_ratio = std::exp(ln_trace_ratio);
     trace_ratio /= -(real(wdata.Jperp(double(spin_seg.length()))(0, 0)) / 2);
@@ -159,6 +157,11 @@ namespace triqs_ctseg::moves {
       dsl[dest_left_idx] = new_seg;
       dsl.erase(dsl.begin() + dest_right_idx);
     }
+    config.update_occupancy(orig_color);
+    config.update_occupancy(dest_color);
+
+    wdata.update_K_field(orig_color, spin_seg.tau_c, spin_seg.tau_cdag, -1);
+    wdata.update_K_field(dest_color, spin_seg.tau_cdag, spin_seg.tau_c, -1);
 
     // Remove Jperp line
     auto &jl = config.Jperp_list;
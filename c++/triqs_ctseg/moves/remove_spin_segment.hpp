@@ -29,7 +29,7 @@ namespace triqs_ctseg::moves {
 
     // Internal data
     int line_idx, orig_color, dest_color, dest_right_idx, dest_left_idx;
-    std::vector<segment_t>::const_iterator orig_it, dest_it;
+    seglist_t::const_iterator orig_it, dest_it;
     segment_t spin_seg;
     bool making_full_line;
     double det_sign;
@@ -0,0 +1,175 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include "shift_segment_end.hpp"
+#include "../logs.hpp"
+
+namespace triqs_ctseg::moves {
+
+  double shift_segment_end::attempt() {
+
+    LOG("\n =================== ATTEMPT SHIFT ================ \n");
+
+    // ------------ Choice of segment and end --------------
+    // Select color
+    color    = rng(config.n_color());
+    auto &sl = config.seglists[color];
+    LOG("Shifting at color {}", color);
+
+    if (sl.empty() or is_full_line(sl[0])) {
+      LOG("No operator to shift");
+      return 0;
+    }
+
+    // Select segment, and the end to shift
+    long n_seg   = sl.size();
+    prop_seg_idx = rng(n_seg);
+    old_seg      = sl[prop_seg_idx];
+    shift_c      = (rng(2) == 0);
+    LOG("Shifting the {} of the segment at position {}", (shift_c ? "c" : "cdag"), prop_seg_idx);
+
+    if (shift_c ? old_seg.J_c : old_seg.J_cdag) {
+      LOG("Operator has a spin line attached: cannot shift.");
+      return 0;
+    }
+
+    // The new time is in the window between the neighbouring operators of the color:
+    // the c moves in ]cdag of the segment on its left, own cdag[ and the cdag in ]own c, c of the segment on its right[.
+    // With a single segment, the window is the whole line except the other end. The proposal is symmetric.
+    auto tau_left  = shift_c ? sl[(prop_seg_idx - 1 + n_seg) % n_seg].tau_cdag : old_seg.tau_c;
+    auto tau_right = shift_c ? old_seg.tau_cdag : sl[(prop_seg_idx + 1) % n_seg].tau_c;
+    auto window    = (n_seg == 1) ? tau_t::beta() : tau_left - tau_right;
+    auto dt        = tau_t::random(rng, window);
+    new_seg        = old_seg;
+    if (shift_c)
+      new_seg.tau_c = tau_right + dt;
+    else
+      new_seg.tau_cdag = tau_left - dt;
+    LOG("New segment: c at {}, cdag at {}", new_seg.tau_c, new_seg.tau_cdag);
+
+    auto tau_old = shift_c ? old_seg.tau_c : old_seg.tau_cdag;
+    auto tau_new = shift_c ? new_seg.tau_c : new_seg.tau_cdag;
+    if (tau_new == tau_old) {
+      LOG("Generated the same time");
+      return 0;
+    }
+
+    // ------------  Trace ratio  -------------
+    // The shift inserts a c at tau_a and a cdag at tau_b, one of them cancelling the old operator:
+    // it adds the segment [tau_a, tau_b] if the segment grows, and removes the antisegment [tau_b, tau_a] otherwise.
+    auto tau_a = shift_c ? new_seg.tau_c : old_seg.tau_cdag;
+    auto tau_b = shift_c ? old_seg.tau_c : new_seg.tau_cdag;
+    bool grows = new_seg.length() > old_seg.length();
+
+    auto changed_seg      = grows ? segment_t{tau_a, tau_b} : segment_t{tau_b, tau_a};
+    double s              = grows ? 1 : -1;
+    double ln_trace_ratio = s * wdata.mu(color) * changed_seg.length();
+    for (auto c : range(config.n_color())) {
+      if (c != color) ln_trace_ratio += -s * wdata.U(color, c) * overlap(config, c, changed_seg);
+    }
+    if (wdata.has_Dt) {
+      ln_trace_ratio += K_overlap(config, tau_a, tau_b, color, wdata);
+      ln_trace_ratio += -wdata.K(color, color, changed_seg.length()); // Correct double counting
+    }
+    double trace_ratio = std::exp(ln_trace_ratio);
+
+    // ------------  Proposition ratio ------------
+
+    double prop_ratio = 1;
+
+    // ------------  First stage of the two-stage acceptance ------------
+    // Without the det ratio: the move is rejected here with probability 1 - min(1, |trace_ratio * prop_ratio|)
+    // (the trace ratio can be negative, e.g. with Jperp: its sign is kept for the second stage)
+    if (wdata.delayed_acceptance and rng() >= std::abs(trace_ratio * prop_ratio)) {
+      LOG("Rejected by the trace and proposal ratios");
+      return 0;
+    }
+
+    // ------------  Det ratio  ---------------
+    // Change the column of the c (or the row of the cdag). The times are ordered in the det: if the new time
+    // crosses another operator of the same det, the row or column would have to move, and we reject.
+    auto &bl     = wdata.block_number[color];
+    auto &bl_idx = wdata.index_in_block[color];
+    auto &D      = wdata.dets[bl];
+    if (wdata.offdiag_Delta) {
+      if ((shift_c ? wdata.c_times[bl] : wdata.cdag_times[bl]).contains(tau_new)) {
+        LOG("The proposed time already exists in another line of the same block. Rejecting.");
+        return 0;
+      }
+    }
+    auto get_time = [&D, this](long n) { return (shift_c ? D.get_y(n) : D.get_x(n)).first; };
+    long n        = shift_c ? det_lower_bound_y(D, tau_old) : det_lower_bound_x(D, tau_old);
+    if ((n > 0 and get_time(n - 1) > tau_new) or (n < D.size() - 1 and get_time(n + 1) < tau_new)) {
+      LOG("The new time changes the order of the det. Rejecting.");
+      return 0;
+    }
+    double det_ratio = shift_c ? D.try_change_col(n, {tau_new, bl_idx}) : D.try_change_row(n, {tau_new, bl_idx});
+
+    LOG("trace_ratio  = {}, prop_ratio = {}, det_ratio = {}", trace_ratio, prop_ratio, det_ratio);
+
+    det_sign    = (det_ratio > 0) ? 1.0 : -1.0;
+    double prod = (wdata.delayed_acceptance ? (trace_ratio * prop_ratio < 0 ? -det_ratio : det_ratio)
+                                            : trace_ratio * det_ratio * prop_ratio);
+
+    return (std::isfinite(prod) ? prod : det_sign);
+  }
+
+  //--------------------------------------------------
+
+  double shift_segment_end::accept() {
+
+    LOG("\n - - - - - ====> ACCEPT - - - - - - - - - - -\n");
+
+    LOG("Initial configuration: {}", config);
+
+    // Update the dets
+    auto bl     = wdata.block_number[color];
+    auto bl_idx = int(wdata.index_in_block[color]);
+    wdata.dets[bl].complete_operation();
+    double sign_ratio = wdata.record_remove(bl, {old_seg.tau_cdag, bl_idx}, {old_seg.tau_c, bl_idx});
+    sign_ratio *= wdata.record_insert(bl, {new_seg.tau_cdag, bl_idx}, {new_seg.tau_c, bl_idx});
+
+    // Update the segment. Shifting the c across beta (or 0) changes the order of the list.
+    auto &sl         = config.seglists[color];
+    sl[prop_seg_idx] = new_seg;
+    if (shift_c) fix_ordering_first_last(sl);
+    config.update_occupancy(color);
+
+    // The shift adds a c at tau_a and a cdag at tau_b, see attempt
+    auto tau_a = shift_c ? new_seg.tau_c : old_seg.tau_cdag;
+    auto tau_b = shift_c ? old_seg.tau_c : new_seg.tau_cdag;
+    wdata.update_K_field(color, tau_a, tau_b, 1);
+
+    LOG("Sign ratio is {}", sign_ratio);
+
+    // Check invariant
+    if constexpr (print_logs or ctseg_debug) check_invariant(config, wdata);
+
+    if (sign_ratio * det_sign == -1.0) wdata.minus_sign = true;
+
+    LOG("Configuration is {}", config);
+
+    return sign_ratio;
+  }
+
+  //--------------------------------------------------
+  void shift_segment_end::reject() {
+    LOG("\n - - - - - ====> REJECT - - - - - - - - - - -\n");
+    wdata.dets[wdata.block_number[color]].reject_last_try();
+  }
+
+} // namespace triqs_ctseg::moves
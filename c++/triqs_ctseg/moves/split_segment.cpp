@@ -16,7 +16,9 @@
 // Authors: Nikita Kavokine, Hao Lu, Olivier Parcollet, Nils Wentzell
 
 #include "split_segment.hpp"
+#include "heat_bath_color.hpp"
 #include "../logs.hpp"
+#include <numeric>
 
 namespace triqs_ctseg::moves {
 
@@ -24,6 +26,8 @@ namespace triqs_ctseg::moves {
 
     LOG("\n =================== ATTEMPT SPLIT ================ \n");
 
+    if (wdata.heat_bath_color) return attempt_heat_bath();
+
     // ------------ Choice of segment --------------
     // Select color
     color    = rng(config.n_color());
@@ -62,19 +66,38 @@ namespace triqs_ctseg::moves {
 
     double ln_trace_ratio = -wdata.mu(color) * removed_segment.length();
     for (auto c : range(config.n_color())) {
-      if (c != color) { ln_trace_ratio -= -wdata.U(color, c) * overlap(config.seglists[c], removed_segment); }
-      if (wdata.has_Dt) { ln_trace_ratio += K_overlap(config.seglists[c], tau_right, tau_left, wdata.K, color, c); }
+      if (c != color) { ln_trace_ratio -= -wdata.U(color, c) * overlap(config, c, removed_segment); }
+    }
+    if (wdata.has_Dt) {
+      ln_trace_ratio += K_overlap(config, tau_right, tau_left, color, wdata);
+      ln_trace_ratio += -wdata.K(color, color, tau_left - tau_right); // Correct double counting
     }
-    if (wdata.has_Dt)
-      ln_trace_ratio += -real(wdata.K(double(tau_left - tau_right))(color, color)); // Correct double counting
     double trace_ratio = std::exp(ln_trace_ratio);
 
+    // ------------  Proposition ratio ------------
+
+    double current_number_segments = sl.size();
+    double future_number_intervals = splitting_full_line ? 1 : sl.size() + 1;
+    // T direct 1/  # segment  1/ len(prop_seg) ^2 * (2 iif !full line)
+    // T inverse : 1/ # interval
+    double prop_ratio =
+       (current_number_segments * prop_seg.length() * prop_seg.length() / (splitting_full_line ? 1 : 2))
+       / (future_number_intervals);
+
+    // ------------  First stage of the two-stage acceptance ------------
+    // Without the det ratio: the move is rejected here with probability 1 - min(1, |trace_ratio * prop_ratio|)
+    // (the trace ratio can be negative, e.g. with Jperp: its sign is kept for the second stage)
+    if (wdata.delayed_acceptance and rng() >= std::abs(trace_ratio * prop_ratio)) {
+      LOG("Rejected by the trace and proposal ratios");
+      return 0;
+    }
+
     // ------------  Det ratio  ---------------
     auto &bl     = wdata.block_number[color];
     auto &bl_idx = wdata.index_in_block[color];
     auto &D      = wdata.dets[bl];
     if (wdata.offdiag_Delta) {
-      if (cdag_in_det(tau_left, D) or c_in_det(tau_right, D)) {
+      if (wdata.cdag_times[bl].contains(tau_left) or wdata.c_times[bl].contains(tau_right)) {
         LOG("One of the proposed times already exists in another line of the same block. Rejecting.");
         return 0;
       }
@@ -83,20 +106,77 @@ namespace triqs_ctseg::moves {
                                   det_lower_bound_y(D, tau_right), //
                                   {tau_left, bl_idx}, {tau_right, bl_idx});
 
-    // ------------  Proposition ratio ------------
+    LOG("trace_ratio  = {}, prop_ratio = {}, det_ratio = {}", trace_ratio, prop_ratio, det_ratio);
 
-    double current_number_segments = sl.size();
+    det_sign    = (det_ratio > 0) ? 1.0 : -1.0;
+    double prod = (wdata.delayed_acceptance ? (trace_ratio * prop_ratio < 0 ? -det_ratio : det_ratio)
+                                            : trace_ratio * det_ratio * prop_ratio);
+
+    return (std::isfinite(prod) ? prod : det_sign);
+  }
+
+  //--------------------------------------------------
+
+  double split_segment::attempt_heat_bath() {
+
+    // ------------ Choice of segment --------------
+    // Choose the times uniformly in [0, beta[, then the color among those where a segment contains
+    // the antisegment [tau_left, tau_right], with a probability proportional to its trace ratio (heat bath)
+    tau_left  = tau_t::random(rng, tau_t::beta());
+    tau_right = tau_t::random(rng, tau_t::beta());
+    if (tau_left == tau_right) {
+      LOG("Generated equal times");
+      return 0;
+    }
+
+    auto w       = heat_bath_color_weights(config, wdata, tau_right, tau_left, true);
+    double sum_w = std::accumulate(w.begin(), w.end(), 0.0);
+    if (sum_w == 0) {
+      LOG("No segment to split in any color.");
+      return 0;
+    }
+    color               = heat_bath_choice(w, sum_w, rng);
+    auto &sl            = config.seglists[color];
+    prop_seg_idx        = segment_around(sl, tau_left);
+    splitting_full_line = is_full_line(sl[prop_seg_idx]);
+    LOG("Splitting at color {}, position {} : adding c at {}, cdag at {}", color, prop_seg_idx, tau_right, tau_left);
+
+    // ------------  Trace ratio  -------------
     double future_number_intervals = splitting_full_line ? 1 : sl.size() + 1;
-    // T direct 1/  # segment  1/ len(prop_seg) ^2 * (2 iif !full line)
-    // T inverse : 1/ # interval
-    double prop_ratio =
-       (current_number_segments * prop_seg.length() * prop_seg.length() / (splitting_full_line ? 1 : 2))
-       / (future_number_intervals);
+    double trace_ratio             = w[color] * future_number_intervals;
+
+    // ------------  Proposition ratio ------------
+    // T direct  = 1/beta^2 * w[color] / sum_w
+    // T inverse = 1 / n_color / future_number_intervals
+    auto beta         = double(tau_t::beta());
+    double prop_ratio = beta * beta * sum_w / (w[color] * config.n_color() * future_number_intervals);
+
+    // ------------  First stage of the two-stage acceptance ------------
+    if (wdata.delayed_acceptance and rng() >= std::abs(trace_ratio * prop_ratio)) {
+      LOG("Rejected by the trace and proposal ratios");
+      return 0;
+    }
+
+    // ------------  Det ratio  ---------------
+    // Same as in attempt
+    auto &bl     = wdata.block_number[color];
+    auto &bl_idx = wdata.index_in_block[color];
+    auto &D      = wdata.dets[bl];
+    if (wdata.offdiag_Delta) {
+      if (wdata.cdag_times[bl].contains(tau_left) or wdata.c_times[bl].contains(tau_right)) {
+        LOG("One of the proposed times already exists in another line of the same block. Rejecting.");
+        return 0;
+      }
+    }
+    auto det_ratio = D.try_insert(det_lower_bound_x(D, tau_left),  //
+                                  det_lower_bound_y(D, tau_right), //
+                                  {tau_left, bl_idx}, {tau_right, bl_idx});
 
     LOG("trace_ratio  = {}, prop_ratio = {}, det_ratio = {}", trace_ratio, prop_ratio, det_ratio);
 
     det_sign    = (det_ratio > 0) ? 1.0 : -1.0;
-    double prod = trace_ratio * det_ratio * prop_ratio;
+    double prod = (wdata.delayed_acceptance ? (trace_ratio * prop_ratio < 0 ? -det_ratio : det_ratio)
+                                            : trace_ratio * det_ratio * prop_ratio);
 
     return (std::isfinite(prod) ? prod : det_sign);
   }
@@ -107,11 +187,13 @@ namespace triqs_ctseg::moves {
 
     LOG("\n - - - - - ====> ACCEPT - - - - - - - - - - -\n");
 
-    double initial_sign = trace_sign(wdata);
-    LOG("Initial sign is {}. Initial configuration: {}", initial_sign, config);
+    LOG("Initial configuration: {}", config);
 
     // Update the dets
-    wdata.dets[wdata.block_number[color]].complete_operation();
+    auto bl     = wdata.block_number[color];
+    auto bl_idx = int(wdata.index_in_block[color]);
+    wdata.dets[bl].complete_operation();
+    double sign_ratio = wdata.record_insert(bl, {tau_left, bl_idx}, {tau_right, bl_idx});
 
     // Split the segment
     auto &sl = config.seglists[color];
@@ -129,10 +211,10 @@ namespace triqs_ctseg::moves {
       bool insert_at_front = is_cyclic(prop_seg) and not is_cyclic(new_seg_right);
       sl.insert(sl.begin() + (insert_at_front ? 0 : prop_seg_idx + 1), new_seg_right);
     }
+    config.update_occupancy(color);
+    wdata.update_K_field(color, tau_right, tau_left, 1);
 
-    double final_sign = trace_sign(wdata);
-    double sign_ratio = final_sign / initial_sign;
-    LOG("Final sign is {}", final_sign);
+    LOG("Sign ratio is {}", sign_ratio);
 
     // Check invariant
     if constexpr (print_logs or ctseg_debug) check_invariant(config, wdata);
@@ -34,6 +34,9 @@ namespace triqs_ctseg::moves {
     bool splitting_full_line;
     double det_sign;
 
+    // Attempt with the heat-bath choice of the color (heat_bath_color)
+    double attempt_heat_bath();
+
     public:
     split_segment(work_data_t &data_, configuration_t &config_, triqs::mc_tools::random_generator &rng_)
        : wdata(data_), config(config_), rng(rng_) {};
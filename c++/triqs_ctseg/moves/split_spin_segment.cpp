@@ -62,15 +62,23 @@ namespace triqs_ctseg::moves {
 
     // Correct for the dynamical interaction between the two operators that have been moved
     if (wdata.has_Dt) {
-      ln_trace_ratio -= real(wdata.K(double(tau_up - old_seg_dn.tau_c))(0, 1));
-      ln_trace_ratio -= real(wdata.K(double(tau_dn - old_seg_up.tau_c))(0, 1));
-      ln_trace_ratio += real(wdata.K(double(tau_dn - tau_up))(0, 1));
-      ln_trace_ratio += real(wdata.K(double(old_seg_up.tau_c - old_seg_dn.tau_c))(0, 1));
+      ln_trace_ratio -= wdata.K(0, 1, tau_up - old_seg_dn.tau_c);
+      ln_trace_ratio -= wdata.K(0, 1, tau_dn - old_seg_up.tau_c);
+      ln_trace_ratio += wdata.K(0, 1, tau_dn - tau_up);
+      ln_trace_ratio += wdata.K(0, 1, old_seg_up.tau_c - old_seg_dn.tau_c);
     }
 
     double trace_ratio = std::exp(ln_trace_ratio);
     trace_ratio /= -real(wdata.Jperp(double(line.tau_Splus - line.tau_Sminus))(0, 0)) / 2;
 
+    // ------------  First stage of the two-stage acceptance ------------
+    // Without the det ratio: the move is rejected here with probability 1 - min(1, |trace_ratio * prop_ratio|)
+    // (the trace ratio can be negative, e.g. with Jperp: its sign is kept for the second stage)
+    if (wdata.delayed_acceptance and rng() >= std::abs(trace_ratio * prop_ratio)) {
+      LOG("Rejected by the trace and proposal ratios");
+      return 0;
+    }
+
     // ----------- Det ratio -----------
     double det_ratio = 1;
 
@@ -88,7 +96,8 @@ namespace triqs_ctseg::moves {
 
     LOG("trace_ratio  = {}, prop_ratio = {}, det_ratio = {}", trace_ratio, prop_ratio, det_ratio);
 
-    double prod = trace_ratio * det_ratio * prop_ratio;
+    double prod = (wdata.delayed_acceptance ? (trace_ratio * prop_ratio < 0 ? -det_ratio : det_ratio)
+                                            : trace_ratio * det_ratio * prop_ratio);
     det_sign    = (det_ratio > 0) ? 1.0 : -1.0;
 
     return (std::isfinite(prod) ? prod : det_sign);
@@ -100,8 +109,7 @@ namespace triqs_ctseg::moves {
 
     LOG("\n - - - - - ====> ACCEPT - - - - - - - - - - -\n");
 
-    double initial_sign = trace_sign(wdata);
-    LOG("Initial sign is {}. Initial configuration: {}", initial_sign, config);
+    LOG("Initial configuration: {}", config);
 
     // Update the dets
     wdata.dets[0].complete_operation();
@@ -111,6 +119,12 @@ namespace triqs_ctseg::moves {
     auto &sl_up = config.seglists[0];
     auto &sl_dn = config.seglists[1];
 
+    double sign_ratio = wdata.record_insert(0, {sl_up[idx_cdag_up].tau_cdag, 0}, {tau_up, 0})
+       * wdata.record_insert(1, {sl_dn[idx_cdag_dn].tau_cdag, 0}, {tau_dn, 0});
+
+    // The c operators move: remove the old ones and add the new ones in the K field
+    wdata.update_K_field(0, tau_up, sl_up[idx_c_up].tau_c, 1);
+    wdata.update_K_field(1, tau_dn, sl_dn[idx_c_dn].tau_c, 1);
     sl_up[idx_c_up].tau_c = tau_up;
     sl_dn[idx_c_dn].tau_c = tau_dn;
 
@@ -122,15 +136,14 @@ namespace triqs_ctseg::moves {
 
     fix_ordering_first_last(sl_up);
     fix_ordering_first_last(sl_dn);
+    config.update_occupancy(0);
+    config.update_occupancy(1);
 
     // Remove Jperp line
     auto &jl = config.Jperp_list;
     jl.erase(begin(jl) + line_idx);
 
-    // Compute sign
-    double final_sign = trace_sign(wdata);
-    double sign_ratio = final_sign / initial_sign;
-    LOG("Final sign is {}", final_sign);
+    LOG("Sign ratio is {}", sign_ratio);
 
     // Check invariant
     if constexpr (print_logs or ctseg_debug) check_invariant(config, wdata);
@@ -194,15 +207,15 @@ namespace triqs_ctseg::moves {
     ln_trace_ratio += wdata.mu(color) * (double(new_seg.length()) - double(sl[idx_c].length()));
     for (auto const &[c, slc] : itertools::enumerate(config.seglists)) {
       if (c != color) {
-        ln_trace_ratio += -wdata.U(c, color) * overlap(slc, new_seg);
-        ln_trace_ratio -= -wdata.U(c, color) * overlap(slc, sl[idx_c]);
+        ln_trace_ratio += -wdata.U(c, color) * overlap(config, c, new_seg);
+        ln_trace_ratio -= -wdata.U(c, color) * overlap(config, c, sl[idx_c]);
       }
       if (wdata.has_Dt) {
         ln_trace_ratio += K_overlap(slc, tau_c_new, true, wdata.K, c, color);
         ln_trace_ratio -= K_overlap(slc, tau_c, true, wdata.K, c, color);
       }
     }
-    if (wdata.has_Dt) ln_trace_ratio -= real(wdata.K(double(tau_c_new - tau_c))(color, color));
+    if (wdata.has_Dt) ln_trace_ratio -= wdata.K(color, color, tau_c_new - tau_c);
 
     // --------- Prop ratio ---------
     // T direct  = 1/window_length
@@ -0,0 +1,123 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include "tuned_move_set.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace triqs_ctseg::moves {
+
+  namespace {
+    // Time of a call to fun, added to time (in seconds)
+    auto timed(auto &&fun, std::function<double()> const &clock, double &time) {
+      double start = clock();
+      auto res     = fun();
+      time += clock() - start;
+      return res;
+    }
+  } // namespace
+
+  tuned_move_set::tuned_move_set(triqs::mc_tools::random_generator &rng, long n_tuning_proposals)
+     : data(std::make_shared<data_t>(data_t{rng, n_tuning_proposals})) {
+    data->clock = []() {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+  }
+
+  //--------------------------------------------------
+
+  double tuned_move_set::attempt() {
+    auto &d = *data;
+    if (d.n_proposals++ == d.n_tuning_proposals) tune();
+
+    // Choose a move with a probability proportional to its weight
+    double total = 0;
+    for (auto const &e : d.entries) total += e.weight;
+    double r  = d.rng(total);
+    d.current = 0;
+    while (d.current < long(d.entries.size()) - 1 and r >= d.entries[d.current].weight)
+      r -= d.entries[d.current++].weight;
+
+    auto &e = d.entries[d.current];
+    ++e.stats.n_proposed;
+    if (d.n_proposals > d.n_tuning_proposals) return e.attempt();
+    ++e.tuning_stats.n_proposed;
+    return timed(e.attempt, d.clock, e.tuning_stats.time);
+  }
+
+  //--------------------------------------------------
+
+  double tuned_move_set::accept() {
+    auto &d = *data;
+    auto &e = d.entries[d.current];
+    ++e.stats.n_accepted;
+    if (d.n_proposals > d.n_tuning_proposals) return e.accept();
+    ++e.tuning_stats.n_accepted;
+    return timed(e.accept, d.clock, e.tuning_stats.time);
+  }
+
+  //--------------------------------------------------
+
+  void tuned_move_set::reject() {
+    auto &d = *data;
+    auto &e = d.entries[d.current];
+    if (d.n_proposals > d.n_tuning_proposals)
+      e.reject();
+    else
+      timed(
+         [&e]() {
+           e.reject();
+           return 0;
+         },
+         d.clock, e.tuning_stats.time);
+  }
+
+  //--------------------------------------------------
+
+  void tuned_move_set::tune() {
+    // Accepted updates per second of each group
+    std::map<std::string, std::pair<long, double>> group_stats;
+    for (auto const &e : data->entries) {
+      group_stats[e.group].first += e.tuning_stats.n_accepted;
+      group_stats[e.group].second += e.tuning_stats.time;
+    }
+    std::map<std::string, double> efficiency;
+    double max_efficiency = 0;
+    for (auto const &[group, s] : group_stats) {
+      efficiency[group] = (s.second > 0 ? s.first / s.second : 0);
+      max_efficiency    = std::max(max_efficiency, efficiency[group]);
+    }
+    if (max_efficiency == 0) return; // Nothing was accepted, keep the weights
+    for (auto &e : data->entries) e.weight = std::max(efficiency[e.group] / max_efficiency, min_weight);
+  }
+
+  //--------------------------------------------------
+
+  std::map<std::string, double> tuned_move_set::weights() const {
+    std::map<std::string, double> res;
+    for (auto const &e : data->entries) res[e.name] = e.weight;
+    return res;
+  }
+
+  std::map<std::string, std::pair<tuned_move_set::stats_t, tuned_move_set::stats_t>>
+  tuned_move_set::statistics() const {
+    std::map<std::string, std::pair<stats_t, stats_t>> res;
+    for (auto const &e : data->entries) res[e.name] = {e.stats, e.tuning_stats};
+    return res;
+  }
+
+} // namespace triqs_ctseg::moves
@@ -0,0 +1,99 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#pragma once
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <triqs/mc_tools/random_generator.hpp>
+
+namespace triqs_ctseg::moves {
+
+  /**
+   * A set of moves, proposed with weights tuned during the warmup.
+   *
+   * It is registered as a single move of the Monte Carlo: at each attempt, one of its moves is chosen with a
+   * probability proportional to its weight. During the first n_tuning_proposals attempts, the number of accepted
+   * updates and the time spent in each move are recorded. The weight of each move is then set to its number of
+   * accepted updates per second, relative to the best move and at least min_weight (so that every move is still
+   * proposed). A move and its inverse (e.g. insert and remove) belong to the same group, and are given the same
+   * weight to preserve detailed balance.
+   *
+   * The copies of a tuned_move_set share the same moves and statistics. The Monte Carlo only sees the set: the
+   * acceptance statistics of each move over the whole run are kept here (see statistics()).
+   */
+  class tuned_move_set {
+    public:
+    // Minimal weight after tuning, relative to the best move
+    static constexpr double min_weight = 0.05;
+
+    // Statistics of a move
+    struct stats_t {
+      long n_proposed = 0, n_accepted = 0;
+      double time = 0; // Time spent in the move during the tuning, in seconds
+    };
+
+    private:
+    struct entry_t {
+      std::string name, group;
+      double weight;
+      std::function<double()> attempt, accept;
+      std::function<void()> reject;
+      stats_t stats, tuning_stats;
+    };
+
+    struct data_t {
+      triqs::mc_tools::random_generator &rng;
+      long n_tuning_proposals;
+      long n_proposals = 0;
+      std::vector<entry_t> entries;
+      long current = 0;              // Index of the move of the current attempt
+      std::function<double()> clock; // Current time in seconds, used to time the moves during the tuning
+    };
+    std::shared_ptr<data_t> data;
+
+    // Set the weights from the statistics of the tuning
+    void tune();
+
+    public:
+    tuned_move_set(triqs::mc_tools::random_generator &rng, long n_tuning_proposals);
+
+    /// Replace the clock used to time the moves (returns the current time in seconds), e.g. to inject the timings
+    void set_clock(std::function<double()> clock) { data->clock = std::move(clock); }
+
+    /// Add a move, with its initial weight and its group (the same for a move and its inverse)
+    template <typename Move> void add(Move &&m, std::string name, double weight, std::string group) {
+      auto move = std::make_shared<std::decay_t<Move>>(std::forward<Move>(m));
+      data->entries.push_back(entry_t{std::move(name), std::move(group), weight, [move]() { return move->attempt(); },
+                                      [move]() { return move->accept(); }, [move]() { move->reject(); }, {}, {}});
+    }
+
+    // ------------------
+    double attempt();
+    double accept();
+    void reject();
+
+    /// Current weights of the moves, by name
+    [[nodiscard]] std::map<std::string, double> weights() const;
+
+    /// Statistics of the moves, by name: over the whole run, and during the tuning
+    [[nodiscard]] std::map<std::string, std::pair<stats_t, stats_t>> statistics() const;
+  };
+
+} // namespace triqs_ctseg::moves
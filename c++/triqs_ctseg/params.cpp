@@ -50,7 +50,10 @@ namespace triqs_ctseg {
     h5_write(grp, "h_int", c.h_int);
     h5_write(grp, "h_loc0", c.h_loc0);
     h5_write(grp, "n_tau_G", c.n_tau_G);
+    h5_write(grp, "n_legendre_G", c.n_legendre_G);
+    h5_write(grp, "n_iw_G", c.n_iw_G);
     h5_write(grp, "n_tau_chi2", c.n_tau_chi2);
+    h5_write(grp, "n_iw_chi2", c.n_iw_chi2);
     h5_write(grp, "n_w_b_vertex", c.n_w_b_vertex);
     h5_write(grp, "n_w_f_vertex", c.n_w_f_vertex);
     h5_write(grp, "n_cycles", c.n_cycles);
@@ -70,22 +73,46 @@ namespace triqs_ctseg {
     h5_write(grp, "move_split_spin_segment", c.move_split_spin_segment);
     h5_write(grp, "move_regroup_spin_segment", c.move_regroup_spin_segment);
     h5_write(grp, "move_swap_spin_lines", c.move_swap_spin_lines);
+    h5_write(grp, "move_shift_segment_end", c.move_shift_segment_end);
+    h5_write(grp, "color_permutations", c.color_permutations);
+    h5_write(grp, "move_weights", c.move_weights);
+    h5_write(grp, "n_tuning_cycles", c.n_tuning_cycles);
+    h5_write(grp, "delayed_acceptance", c.delayed_acceptance);
+    h5_write(grp, "heat_bath_color", c.heat_bath_color);
     h5_write(grp, "measure_pert_order", c.measure_pert_order);
     h5_write(grp, "measure_G_tau", c.measure_G_tau);
     h5_write(grp, "measure_F_tau", c.measure_F_tau);
+    h5_write(grp, "measure_G_l", c.measure_G_l);
+    h5_write(grp, "measure_F_l", c.measure_F_l);
+    h5_write(grp, "measure_G_iw", c.measure_G_iw);
+    h5_write(grp, "measure_F_iw", c.measure_F_iw);
     h5_write(grp, "measure_densities", c.measure_densities);
     h5_write(grp, "measure_average_sign", c.measure_average_sign);
     h5_write(grp, "measure_nn_static", c.measure_nn_static);
     h5_write(grp, "measure_nn_tau", c.measure_nn_tau);
+    h5_write(grp, "nn_tau_average", c.nn_tau_average);
+    h5_write(grp, "measure_nn_iw", c.measure_nn_iw);
     h5_write(grp, "measure_Sperp_tau", c.measure_Sperp_tau);
     h5_write(grp, "measure_state_hist", c.measure_state_hist);
     h5_write(grp, "measure_g3w", c.measure_g3w);
     h5_write(grp, "measure_f3w", c.measure_f3w);
+    h5_write(grp, "use_K_field", c.use_K_field);
+    h5_write(grp, "use_K_channels", c.use_K_channels);
+    h5_write(grp, "K_channel_tolerance", c.K_channel_tolerance);
     h5_write(grp, "det_init_size", c.det_init_size);
     h5_write(grp, "det_n_operations_before_check", c.det_n_operations_before_check);
+    h5_write(grp, "det_adaptive_check", c.det_adaptive_check);
     h5_write(grp, "det_precision_warning", c.det_precision_warning);
     h5_write(grp, "det_precision_error", c.det_precision_error);
     h5_write(grp, "det_singular_threshold", c.det_singular_threshold);
+    h5_write(grp, "det_n_delayed_updates", c.det_n_delayed_updates);
+    h5_write(grp, "det_small_max_order", c.det_small_max_order);
+    h5_write(grp, "det_split_blocks", c.det_split_blocks);
+    h5_write(grp, "det_split_tolerance", c.det_split_tolerance);
+    h5_write(grp, "Delta_representation", c.Delta_representation);
+    h5_write(grp, "Delta_n_poles", c.Delta_n_poles);
+    h5_write(grp, "Delta_pole_energy_max", c.Delta_pole_energy_max);
+    h5_write(grp, "Delta_fit_tolerance", c.Delta_fit_tolerance);
     h5_write(grp, "histogram_max_order", c.histogram_max_order);
   }
 
@@ -98,7 +125,10 @@ namespace triqs_ctseg {
     h5_read(grp, "h_int", c.h_int);
     h5_read(grp, "h_loc0", c.h_loc0);
     h5_read(grp, "n_tau_G", c.n_tau_G);
+    h5_read(grp, "n_legendre_G", c.n_legendre_G);
+    h5_read(grp, "n_iw_G", c.n_iw_G);
     h5_read(grp, "n_tau_chi2", c.n_tau_chi2);
+    h5_read(grp, "n_iw_chi2", c.n_iw_chi2);
     h5_read(grp, "n_cycles", c.n_cycles);
     h5_read(grp, "length_cycle", c.length_cycle);
     h5_read(grp, "n_warmup_cycles", c.n_warmup_cycles);
@@ -116,22 +146,46 @@ namespace triqs_ctseg {
     h5_read(grp, "move_split_spin_segment", c.move_split_spin_segment);
     h5_read(grp, "move_regroup_spin_segment", c.move_regroup_spin_segment);
     h5_read(grp, "move_swap_spin_lines", c.move_swap_spin_lines);
+    h5_read(grp, "move_shift_segment_end", c.move_shift_segment_end);
+    h5_read(grp, "color_permutations", c.color_permutations);
+    h5_read(grp, "move_weights", c.move_weights);
+    h5_read(grp, "n_tuning_cycles", c.n_tuning_cycles);
+    h5_read(grp, "delayed_acceptance", c.delayed_acceptance);
+    h5_read(grp, "heat_bath_color", c.heat_bath_color);
     h5_read(grp, "measure_pert_order", c.measure_pert_order);
     h5_read(grp, "measure_G_tau", c.measure_G_tau);
     h5_read(grp, "measure_F_tau", c.measure_F_tau);
+    h5_read(grp, "measure_G_l", c.measure_G_l);
+    h5_read(grp, "measure_F_l", c.measure_F_l);
+    h5_read(grp, "measure_G_iw", c.measure_G_iw);
+    h5_read(grp, "measure_F_iw", c.measure_F_iw);
     h5_read(grp, "measure_densities", c.measure_densities);
     h5_read(grp, "measure_average_sign", c.measure_average_sign);
     h5_read(grp, "measure_nn_static", c.measure_nn_static);
     h5_read(grp, "measure_nn_tau", c.measure_nn_tau);
+    h5_read(grp, "nn_tau_average", c.nn_tau_average);
+    h5_read(grp, "measure_nn_iw", c.measure_nn_iw);
     h5_read(grp, "measure_Sperp_tau", c.measure_Sperp_tau);
     h5_read(grp, "measure_state_hist", c.measure_state_hist);
     h5_read(grp, "measure_g3w", c.measure_g3w);
     h5_read(grp, "measure_f3w", c.measure_f3w);
+    h5_read(grp, "use_K_field", c.use_K_field);
+    h5_read(grp, "use_K_channels", c.use_K_channels);
+    h5_read(grp, "K_channel_tolerance", c.K_channel_tolerance);
     h5_read(grp, "det_init_size", c.det_init_size);
     h5_read(grp, "det_n_operations_before_check", c.det_n_operations_before_check);
+    h5_read(grp, "det_adaptive_check", c.det_adaptive_check);
     h5_read(grp, "det_precision_warning", c.det_precision_warning);
     h5_read(grp, "det_precision_error", c.det_precision_error);
     h5_read(grp, "det_singular_threshold", c.det_singular_threshold);
+    h5_read(grp, "det_n_delayed_updates", c.det_n_delayed_updates);
+    h5_read(grp, "det_small_max_order", c.det_small_max_order);
+    h5_read(grp, "det_split_blocks", c.det_split_blocks);
+    h5_read(grp, "det_split_tolerance", c.det_split_tolerance);
+    h5_read(grp, "Delta_representation", c.Delta_representation);
+    h5_read(grp, "Delta_n_poles", c.Delta_n_poles);
+    h5_read(grp, "Delta_pole_energy_max", c.Delta_pole_energy_max);
+    h5_read(grp, "Delta_fit_tolerance", c.Delta_fit_tolerance);
     h5_read(grp, "histogram_max_order", c.histogram_max_order);
   }
 
@@ -54,9 +54,18 @@ namespace triqs_ctseg {
     /// Number of points on which to measure G(tau)/F(tau) (defaults to n_tau)
     int n_tau_G = 0;
 
+    /// Number of Legendre coefficients of G_l/F_l
+    int n_legendre_G = 50;
+
+    /// Number of positive fermionic Matsubara frequencies of G_iw/F_iw
+    int n_iw_G = 500;
+
     /// Number of points on which to measure 2-point functions (defaults to n_tau_bosonic)
     int n_tau_chi2 = 0;
 
+    /// Number of non-negative bosonic Matsubara frequencies on which to measure nn_iw
+    int n_iw_chi2 = 100;
+
     /// Number of bosonic M-frequency points on which to measure vertex functions
     int n_w_b_vertex = 10;
 
@@ -116,6 +125,24 @@ namespace triqs_ctseg {
     /// Whether to perform the move swap spin lines
     bool move_swap_spin_lines = true;
 
+    /// Whether to perform the move shift segment end (shift a single c or cdag of a segment)
+    bool move_shift_segment_end = false;
+
+    /// Color permutations (new color of each color) for the move permute colors. Symmetries of mu, U and D0(tau)
+    std::vector<std::vector<long>> color_permutations = {};
+
+    /// Proposal weights of the moves by name ("insert", "spin split", ...), default 1. Equal for a move and its inverse
+    std::map<std::string, double> move_weights = {};
+
+    /// Number of warmup cycles at the start of the warmup used to tune the move weights (0: no tuning)
+    int n_tuning_cycles = 0;
+
+    /// Two-stage acceptance: reject from the trace and proposal ratios first, before computing the det ratio
+    bool delayed_acceptance = false;
+
+    /// Heat-bath choice of the color in insert/remove and split/regroup segment, for the times drawn uniformly
+    bool heat_bath_color = false;
+
     // -------- Measure control --------------
 
     /// Whether to measure the perturbation order histograms (order in Delta and Jperp)
@@ -127,6 +154,18 @@ namespace triqs_ctseg {
     /// Whether to measure F(tau) (see measures/G_F_tau)
     bool measure_F_tau = false;
 
+    /// Whether to measure G_l, the Legendre coefficients of G(tau) (see measures/G_F_l)
+    bool measure_G_l = false;
+
+    /// Whether to measure F_l, the Legendre coefficients of F(tau), along with G_l (see measures/G_F_l)
+    bool measure_F_l = false;
+
+    /// Whether to measure G(iw) directly, by a non-uniform Fourier transform of the det entries (see measures/G_F_iw)
+    bool measure_G_iw = false;
+
+    /// Whether to measure F(iw) as well, along with G(iw) (see measures/G_F_iw)
+    bool measure_F_iw = false;
+
     /// Whether to measure densities (see measures/densities)
     bool measure_densities = true;
 
@@ -139,6 +178,12 @@ namespace triqs_ctseg {
     /// Whether to measure <n(tau)n(0)> (see measures/nn_tau)
     bool measure_nn_tau = false;
 
+    /// Measure <n(tau)n(0)> averaged over the reference time (improved estimator, O(n_ops^2) per measure)
+    bool nn_tau_average = false;
+
+    /// Whether to measure <n(i nu)n(-i nu)> (see measures/nn_iw)
+    bool measure_nn_iw = false;
+
     /// Whether to measure <S_x(tau)S_x(0)> (see measures/Sperp_tau)
     bool measure_Sperp_tau = false;
 
@@ -153,12 +198,24 @@ namespace triqs_ctseg {
 
     // -------- Misc parameters --------------
 
+    /// Compute the K(tau) overlaps in the moves from an incrementally updated retarded field (see K_field.hpp)
+    bool use_K_field = false;
+
+    /// Store the retarded field of K(tau) in a few color channels if K(tau) is low-rank (needs use_K_field)
+    bool use_K_channels = false;
+
+    /// Maximum error of the channel factorization of K(tau)
+    double K_channel_tolerance = 1.e-10;
+
     /// The maximum size of the determinant matrix before a resize
     int det_init_size = 100;
 
     /// Max number of ops before the test of deviation of the det, M^-1 is performed.
     int det_n_operations_before_check = 100;
 
+    /// Adapt the interval between two det checks to the measured deviation (det_n_operations_before_check is the first)
+    bool det_adaptive_check = false;
+
     /// Threshold for determinant precision warnings
     double det_precision_warning = 1.e-8;
 
@@ -168,6 +225,30 @@ namespace triqs_ctseg {
     /// Bound for the determinant matrix being singular, abs(det) > singular_threshold. If <0, it is !isnormal(abs(det))
     double det_singular_threshold = -1;
 
+    /// Number of accepted updates of a det applied at once as a rank-k update of its inverse (0: rank-1 updates)
+    int det_n_delayed_updates = 0;
+
+    /// Dets of order at most this use inline storage, tuned for small orders (0: none). See det_t in dets.hpp
+    int det_small_max_order = 0;
+
+    /// Split the blocks into the connected components of the off-diagonal structure of Delta(tau), with one det each
+    bool det_split_blocks = false;
+
+    /// Off-diagonal elements of Delta(tau) below this are treated as zero when splitting the blocks (det_split_blocks)
+    double det_split_tolerance = 1.e-13;
+
+    /// Representation of Delta(tau) in the dets: "grid" (interpolation on its mesh) or "poles" (sum of exponentials)
+    std::string Delta_representation = "grid";
+
+    /// Number of poles for the fit of Delta(tau) (Delta_representation = "poles")
+    int Delta_n_poles = 61;
+
+    /// Largest pole energy for the fit of Delta(tau) (Delta_representation = "poles")
+    double Delta_pole_energy_max = 20.0;
+
+    /// Maximum error of the pole fit of Delta(tau) on its mesh, above which the grid representation is used
+    double Delta_fit_tolerance = 1.e-6;
+
     /// Maximum order for the perturbation order histograms
     int histogram_max_order = 1000;
   };
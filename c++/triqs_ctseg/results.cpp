@@ -26,7 +26,12 @@ namespace triqs_ctseg {
     h5_write(grp, "G_tau", c.G_tau);
     h5_write(grp, "average_sign", c.average_sign);
     h5_write(grp, "F_tau", c.F_tau);
+    h5_write(grp, "G_l", c.G_l);
+    h5_write(grp, "F_l", c.F_l);
+    h5_write(grp, "G_iw", c.G_iw);
+    h5_write(grp, "F_iw", c.F_iw);
     h5_write(grp, "nn_tau", c.nn_tau);
+    h5_write(grp, "nn_iw", c.nn_iw);
     h5_write(grp, "Sperp_tau", c.Sperp_tau);
     h5_write(grp, "nn_static", c.nn_static);
     h5_write(grp, "densities", c.densities);
@@ -37,6 +42,10 @@ namespace triqs_ctseg {
     h5_write(grp, "state_hist", c.state_hist);
     h5_write(grp, "g3w", c.g3w);
     h5_write(grp, "f3w", c.f3w);
+    h5_write(grp, "det_check_interval", c.det_check_interval);
+    h5_write(grp, "det_max_drift", c.det_max_drift);
+    h5_write(grp, "move_weights", c.move_weights);
+    h5_write(grp, "move_acceptance_rates", c.move_acceptance_rates);
   }
 
   //------------------------------------
@@ -48,7 +57,12 @@ namespace triqs_ctseg {
     h5_read(grp, "G_tau", c.G_tau);
     h5_read(grp, "average_sign", c.average_sign);
     h5_read(grp, "F_tau", c.F_tau);
+    h5_read(grp, "G_l", c.G_l);
+    h5_read(grp, "F_l", c.F_l);
+    h5_read(grp, "G_iw", c.G_iw);
+    h5_read(grp, "F_iw", c.F_iw);
     h5_read(grp, "nn_tau", c.nn_tau);
+    h5_read(grp, "nn_iw", c.nn_iw);
     h5_read(grp, "Sperp_tau", c.Sperp_tau);
     h5_read(grp, "nn_static", c.nn_static);
     h5_read(grp, "densities", c.densities);
@@ -59,6 +73,10 @@ namespace triqs_ctseg {
     h5_read(grp, "state_hist", c.state_hist);
     h5_read(grp, "g3w", c.g3w);
     h5_read(grp, "f3w", c.f3w);
+    h5_read(grp, "det_check_interval", c.det_check_interval);
+    h5_read(grp, "det_max_drift", c.det_max_drift);
+    h5_read(grp, "move_weights", c.move_weights);
+    h5_read(grp, "move_acceptance_rates", c.move_acceptance_rates);
   }
 
 } // namespace triqs_ctseg
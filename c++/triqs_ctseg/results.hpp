@@ -33,9 +33,24 @@ namespace triqs_ctseg {
     /// Self-energy improved estimator :math:`F(\tau)`.
     std::optional<block_gf<imtime>> F_tau;
 
+    /// Legendre coefficients :math:`G_l` of the Green's function.
+    std::optional<block_gf<legendre>> G_l;
+
+    /// Legendre coefficients :math:`F_l` of the self-energy improved estimator.
+    std::optional<block_gf<legendre>> F_l;
+
+    /// Green's function :math:`G(i\omega_n)`, measured directly in Matsubara frequencies.
+    std::optional<block_gf<imfreq>> G_iw;
+
+    /// Self-energy improved estimator :math:`F(i\omega_n)`, measured directly in Matsubara frequencies.
+    std::optional<block_gf<imfreq>> F_iw;
+
     /// Density-density time correlation function :math:`\langle n_a(\tau) n_b(0) \rangle`.
     std::optional<block2_gf<imtime>> nn_tau;
 
+    /// Density-density correlation function in Matsubara frequencies :math:`\langle n_a(\tau) n_b(0) \rangle(i\nu)`.
+    std::optional<block2_gf<imfreq>> nn_iw;
+
     /// Perpendicular spin-spin correlation function :math:`\langle S_x(\tau) S_x(0) \rangle`.
     std::optional<gf<imtime>> Sperp_tau;
 
@@ -66,6 +81,18 @@ namespace triqs_ctseg {
     /// Four-point correlation function improved estimator
     std::optional<block2_gf<prod<imfreq, imfreq, imfreq>, tensor_valued<4>>> f3w;
 
+    /// Interval between two det checks at the end of the run, per det (minimum over the nodes, det_adaptive_check)
+    std::optional<nda::vector<long>> det_check_interval;
+
+    /// Largest deviation of the det inverse found by the checks, per det (det_adaptive_check)
+    std::optional<nda::vector<double>> det_max_drift;
+
+    /// Proposal weights of the moves after tuning, averaged over the nodes (n_tuning_cycles > 0)
+    std::optional<std::map<std::string, double>> move_weights;
+
+    /// Acceptance rate of each move over the whole run, on all nodes (n_tuning_cycles > 0)
+    std::optional<std::map<std::string, double>> move_acceptance_rates;
+
     /// Average sign
     double average_sign;
   };
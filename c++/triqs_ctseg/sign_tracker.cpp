@@ -0,0 +1,80 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include "sign_tracker.hpp"
+#include <algorithm>
+
+namespace triqs_ctseg {
+
+  namespace {
+    // Number of times strictly below / above tau in a sorted vector
+    long n_below(std::vector<tau_t> const &v, tau_t const &tau) {
+      return std::lower_bound(v.begin(), v.end(), tau) - v.begin();
+    }
+    long n_above(std::vector<tau_t> const &v, tau_t const &tau) {
+      return v.end() - std::upper_bound(v.begin(), v.end(), tau);
+    }
+  } // namespace
+
+  long sign_tracker_t::c_increment(tau_t const &tau, int a) const {
+    long res = 0;
+    for (int k = 0; k < int(c_times.size()); ++k) {
+      if (k == a) continue;
+      // Color inversions with the other c, and N_a N_k
+      res += (k > a ? n_below(c_times[k], tau) : n_above(c_times[k], tau)) + long(c_times[k].size());
+    }
+    // Time order within color a
+    return res + n_above(cdag_times[a], tau);
+  }
+
+  long sign_tracker_t::cdag_increment(tau_t const &tau, int a) const {
+    long res = 0;
+    for (int k = 0; k < int(cdag_times.size()); ++k) {
+      if (k > a) res += n_below(cdag_times[k], tau);
+      if (k < a) res += n_above(cdag_times[k], tau);
+    }
+    return res + n_below(c_times[a], tau);
+  }
+
+  double sign_tracker_t::insert(std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y) {
+    double initial_sign = sign();
+    parity += c_increment(y.first, y.second);
+    auto &vc = c_times[y.second];
+    vc.insert(std::upper_bound(vc.begin(), vc.end(), y.first), y.first);
+    parity += cdag_increment(x.first, x.second);
+    auto &vcdag = cdag_times[x.second];
+    vcdag.insert(std::upper_bound(vcdag.begin(), vcdag.end(), x.first), x.first);
+    parity %= 2;
+    ++s;
+    return sign() / initial_sign;
+  }
+
+  double sign_tracker_t::remove(std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y) {
+    double initial_sign = sign();
+    // The increment of the removal is the one of the insertion in the state without the operator
+    auto &vcdag = cdag_times[x.second];
+    vcdag.erase(std::lower_bound(vcdag.begin(), vcdag.end(), x.first));
+    parity += cdag_increment(x.first, x.second);
+    auto &vc = c_times[y.second];
+    vc.erase(std::lower_bound(vc.begin(), vc.end(), y.first));
+    parity += c_increment(y.first, y.second);
+    parity %= 2;
+    --s;
+    return sign() / initial_sign;
+  }
+
+} // namespace triqs_ctseg
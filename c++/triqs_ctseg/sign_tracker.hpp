@@ -0,0 +1,69 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#pragma once
+#include <utility>
+#include <vector>
+#include "./tau_t.hpp"
+
+namespace triqs_ctseg {
+
+  /**
+   * Incremental computation of the sign of the trace of a block (see trace_sign in work_data.hpp).
+   *
+   * With the c and cdag of the det in increasing time order, the sign of the block is $(-1)^{s(s-1)/2 + E}$, where
+   * $s$ is the size of the det and
+   *
+   *   $E = I_c + I_{c^\dagger} + \sum_{k < l} N_k N_l + \sum_k P_k$
+   *
+   * with $I_c$ ($I_{c^\dagger}$) the number of pairs of c (cdag) which are in decreasing color order
+   * in the time order, $N_k$ the number of c of color k and $P_k$ the number of pairs (c, cdag) of color k
+   * with the cdag later than the c. Each of these terms changes by a count of operators above or below a
+   * given time when a single operator is added or removed, so that the parity of E can be maintained in
+   * O(n_colors x log(number of operators)) per update, instead of recomputing the sign from the det in
+   * O(n_colors x size of the det).
+   *
+   * The times are kept per color in sorted vectors, and the tracker must see every insertion and removal
+   * in the det of the block, i.e. be updated in the accept of the moves.
+   */
+  class sign_tracker_t {
+    std::vector<std::vector<tau_t>> c_times;    // c_times[k] = times of the c of color k, sorted
+    std::vector<std::vector<tau_t>> cdag_times; // cdag_times[k] = times of the cdag of color k, sorted
+    long s      = 0;                            // Number of (c, cdag) pairs, i.e. size of the det
+    long parity = 0;                            // E mod 2
+
+    // Change of E (mod 2) when a c (cdag) of color a at tau is added to, or removed from, the current state
+    [[nodiscard]] long c_increment(tau_t const &tau, int a) const;
+    [[nodiscard]] long cdag_increment(tau_t const &tau, int a) const;
+
+    public:
+    sign_tracker_t() = default;
+
+    /// Empty block with n_colors colors
+    explicit sign_tracker_t(int n_colors) : c_times(n_colors), cdag_times(n_colors) {}
+
+    /// Sign of the trace of the block
+    [[nodiscard]] double sign() const { return ((s * (s - 1) / 2 + parity) % 2 == 0) ? 1.0 : -1.0; }
+
+    /// Add a cdag x and a c y (as (time, index in block) pairs, as in the det). Returns the ratio new / old sign.
+    double insert(std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y);
+
+    /// Remove a cdag x and a c y. Returns the ratio new / old sign.
+    double remove(std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y);
+  };
+
+} // namespace triqs_ctseg
@@ -70,47 +70,91 @@ namespace triqs_ctseg {
     // Initialize configuration
     configuration_t config{wdata.n_color};
     // Start from a non-empty configuration when Delta(tau) = 0
-    if (not wdata.has_Delta) { config.seglists[0].push_back(segment_t::full_line()); }
+    if (not wdata.has_Delta) {
+      config.seglists[0].push_back(segment_t::full_line());
+      config.update_occupancy(0);
+    }
 
     // ................   QMC  ...................
 
     auto CTQMC = triqs::mc_tools::mc_generic<double>(p.random_name, p.random_seed, p.verbosity);
 
+    // Proposal weights of the moves. A move and its inverse must have the same weight (detailed balance)
+    auto inverse_move = std::map<std::string, std::string>{
+       {"insert", "remove"},           {"remove", "insert"},           {"move", "move"},
+       {"split", "regroup"},           {"regroup", "split"},           {"spin insert", "spin remove"},
+       {"spin remove", "spin insert"}, {"spin split", "spin regroup"}, {"spin regroup", "spin split"},
+       {"spin swap", "spin swap"},     {"shift", "shift"},             {"permute", "permute"}};
+    for (auto const &[name, w] : p.move_weights) {
+      ALWAYS_EXPECTS(inverse_move.contains(name), "Error: move_weights: unknown move {}", name);
+      ALWAYS_EXPECTS((w > 0), "Error: move_weights: the weight of the move {} must be positive", name);
+    }
+    auto move_weight = [&](std::string const &name) {
+      auto const &inverse = inverse_move[name];
+      auto w              = p.move_weights.contains(name) ? p.move_weights.at(name) : 1.0;
+      if (p.move_weights.contains(inverse)) {
+        ALWAYS_EXPECTS((not p.move_weights.contains(name) or p.move_weights.at(inverse) == w),
+                       "Error: move_weights: the moves {} and {} must have the same weight", name, inverse);
+        w = p.move_weights.at(inverse);
+      }
+      return w;
+    };
+
+    // With n_tuning_cycles > 0, the moves are proposed by a tuned_move_set, registered as a single move
+    ALWAYS_EXPECTS((p.n_tuning_cycles <= p.n_warmup_cycles), "Error: n_tuning_cycles > n_warmup_cycles");
+    bool tune_moves = (p.n_tuning_cycles > 0);
+    auto tuned_moves = moves::tuned_move_set{CTQMC.get_rng(), long(p.n_tuning_cycles) * p.length_cycle};
+    auto add_move    = [&](auto &&move, std::string const &name) {
+      auto group = std::min(name, inverse_move[name]);
+      if (tune_moves)
+        tuned_moves.add(std::forward<decltype(move)>(move), name, move_weight(name), group);
+      else
+        CTQMC.add_move(std::forward<decltype(move)>(move), name, move_weight(name));
+    };
+
     // Initialize moves
     if (wdata.has_Delta) {
-      if (p.move_insert_segment) CTQMC.add_move(moves::insert_segment{wdata, config, CTQMC.get_rng()}, "insert");
-      if (p.move_remove_segment) CTQMC.add_move(moves::remove_segment{wdata, config, CTQMC.get_rng()}, "remove");
-      if (p.move_move_segment) CTQMC.add_move(moves::move_segment{wdata, config, CTQMC.get_rng()}, "move");
-      if (p.move_split_segment) CTQMC.add_move(moves::split_segment{wdata, config, CTQMC.get_rng()}, "split");
-      if (p.move_regroup_segment) CTQMC.add_move(moves::regroup_segment{wdata, config, CTQMC.get_rng()}, "regroup");
+      if (p.move_insert_segment) add_move(moves::insert_segment{wdata, config, CTQMC.get_rng()}, "insert");
+      if (p.move_remove_segment) add_move(moves::remove_segment{wdata, config, CTQMC.get_rng()}, "remove");
+      if (p.move_move_segment) add_move(moves::move_segment{wdata, config, CTQMC.get_rng()}, "move");
+      if (p.move_split_segment) add_move(moves::split_segment{wdata, config, CTQMC.get_rng()}, "split");
+      if (p.move_regroup_segment) add_move(moves::regroup_segment{wdata, config, CTQMC.get_rng()}, "regroup");
+      if (p.move_shift_segment_end) add_move(moves::shift_segment_end{wdata, config, CTQMC.get_rng()}, "shift");
+      if (not p.color_permutations.empty())
+        add_move(moves::permute_colors{wdata, config, CTQMC.get_rng(), p.color_permutations}, "permute");
     }
 
     if (wdata.has_Jperp) {
       if (p.move_insert_spin_segment)
-        CTQMC.add_move(moves::insert_spin_segment{wdata, config, CTQMC.get_rng()}, "spin insert");
+        add_move(moves::insert_spin_segment{wdata, config, CTQMC.get_rng()}, "spin insert");
 
       if (p.move_remove_spin_segment)
-        CTQMC.add_move(moves::remove_spin_segment{wdata, config, CTQMC.get_rng()}, "spin remove");
+        add_move(moves::remove_spin_segment{wdata, config, CTQMC.get_rng()}, "spin remove");
     }
 
     if (wdata.has_Jperp and wdata.has_Delta) {
       if (p.move_split_spin_segment)
-        CTQMC.add_move(moves::split_spin_segment{wdata, config, CTQMC.get_rng()}, "spin split");
+        add_move(moves::split_spin_segment{wdata, config, CTQMC.get_rng()}, "spin split");
 
       if (p.move_regroup_spin_segment)
-        CTQMC.add_move(moves::regroup_spin_segment{wdata, config, CTQMC.get_rng()}, "spin regroup");
+        add_move(moves::regroup_spin_segment{wdata, config, CTQMC.get_rng()}, "spin regroup");
     }
 
     if (wdata.has_Jperp) {
-      if (p.move_swap_spin_lines) CTQMC.add_move(moves::swap_spin_lines{wdata, config, CTQMC.get_rng()}, "spin swap");
+      if (p.move_swap_spin_lines) add_move(moves::swap_spin_lines{wdata, config, CTQMC.get_rng()}, "spin swap");
     }
 
+    if (tune_moves) CTQMC.add_move(tuned_moves, "tuned moves");
+
     // Initialize measurements
     if (p.measure_G_tau) CTQMC.add_measure(measures::G_F_tau{p, wdata, config, results}, "G(tau)/F(tau)");
+    if (p.measure_G_l) CTQMC.add_measure(measures::G_F_l{p, wdata, config, results}, "G_l/F_l");
+    if (p.measure_G_iw) CTQMC.add_measure(measures::G_F_iw{p, wdata, config, results}, "G(iw)/F(iw)");
     if (p.measure_densities) CTQMC.add_measure(measures::densities{p, wdata, config, results}, "Densities");
     if (p.measure_average_sign) CTQMC.add_measure(measures::average_sign{p, wdata, config, results}, "Average Sign");
     if (p.measure_nn_static) CTQMC.add_measure(measures::nn_static{p, wdata, config, results}, "<nn>");
     if (p.measure_nn_tau) CTQMC.add_measure(measures::nn_tau{p, wdata, config, results}, "<n(tau)n(0)>");
+    if (p.measure_nn_iw) CTQMC.add_measure(measures::nn_iw{p, wdata, config, results}, "<n(i nu)n(-i nu)>");
     if (p.measure_Sperp_tau) CTQMC.add_measure(measures::Sperp_tau{p, wdata, config, results}, "<S_x(tau)S_x(0)>");
     if (p.measure_pert_order) {
       if (wdata.has_Delta) {
@@ -133,6 +177,42 @@ namespace triqs_ctseg {
                                 triqs::utility::clock_callback(p.max_time));
     CTQMC.collect_results(c);
 
+    // Report the tuned move weights, and the acceptance rate of each move (mc_generic only sees the whole set)
+    if (tune_moves) {
+      auto weights = tuned_moves.weights();
+      for (auto &[name, w] : weights) w = mpi::all_reduce(w, c) / c.size();
+      results.move_weights = weights;
+      std::map<std::string, double> acceptance_rates;
+      for (auto const &[name, s] : tuned_moves.statistics()) {
+        double n_accepted      = mpi::all_reduce(double(s.first.n_accepted), c);
+        double n_proposed      = mpi::all_reduce(double(s.first.n_proposed), c);
+        acceptance_rates[name] = n_accepted / std::max(n_proposed, 1.0);
+      }
+      results.move_acceptance_rates = acceptance_rates;
+      if (c.rank() == 0) {
+        spdlog::info("Tuned move weights (acceptance rate and time per proposal during the tuning, acceptance rate):");
+        for (auto const &[name, s] : tuned_moves.statistics()) {
+          auto const &t = s.second;
+          spdlog::info("  {:>12}: {:.3f} ({:.3f}, {:.2e} s, {:.3f})", name, weights[name],
+                       double(t.n_accepted) / std::max(t.n_proposed, 1l), t.time / std::max(t.n_proposed, 1l),
+                       acceptance_rates[name]);
+        }
+      }
+    }
+
+    // Report the adaptive det check intervals and the largest deviations
+    if (p.det_adaptive_check) {
+      long n_blocks = long(wdata.dets.size());
+      nda::vector<long> interval(n_blocks);
+      nda::vector<double> drift(n_blocks);
+      for (auto bl : range(n_blocks)) {
+        interval[bl] = mpi::all_reduce(wdata.dets[bl].adaptive_check_interval(), c, MPI_MIN);
+        drift[bl]    = mpi::all_reduce(wdata.dets[bl].max_measured_drift(), c, MPI_MAX);
+      }
+      results.det_check_interval = interval;
+      results.det_max_drift      = drift;
+    }
+
     // Report sign and average order
     if (c.rank() == 0) {
       spdlog::info("Average sign: {}", results.average_sign);
@@ -140,6 +220,10 @@ namespace triqs_ctseg {
         spdlog::info("Average perturbation order in Delta: {:.3f}", results.average_order_Delta.value());
       if (results.average_order_Jperp)
         spdlog::info("Average perturbation order in Jperp: {:.3f}", results.average_order_Jperp.value());
+      if (results.det_check_interval)
+        for (auto bl : range(results.det_check_interval->size()))
+          spdlog::info("Det {}: check interval {}, largest deviation {:.2e}", bl, (*results.det_check_interval)[bl],
+                       (*results.det_max_drift)[bl]);
     }
 
   } // solve
@@ -45,6 +45,9 @@ namespace triqs_ctseg {
     /// $\tau$ value, represented as an integer on a very fine grid
     uint64_t n = 0;
 
+    /// 1 / n_max, for the conversion to a grid position
+    static constexpr double inv_n_max = 1.0 / double(std::numeric_limits<uint64_t>::max());
+
     public:
     /// Maximum value that can be stored inside a uint64_t
     static constexpr uint64_t n_max = std::numeric_limits<uint64_t>::max();
@@ -71,9 +74,22 @@ namespace triqs_ctseg {
     auto operator<=>(tau_t const &tau) const { return n <=> tau.n; }
     bool operator==(tau_t const &tau) const { return n == tau.n; }
 
+    /// Hash of the integer (Fibonacci hashing: the high bits are well mixed), e.g. for time_set_t
+    [[nodiscard]] uint64_t hash() const { return n * uint64_t{0x9E3779B97F4A7C15}; }
+
     /// To cast to double, but it has to be done explicitly.
     explicit operator double() const { return _beta * (double(n) / double(n_max)); }
 
+    /// Position on a uniform grid of $[0,\beta]$ with n_intervals intervals, i.e. $\tau / \beta \times$ n_intervals.
+    /// Computed directly from the integer, without the multiplication by $\beta$ of the cast to double.
+    [[nodiscard]] double grid_position(long n_intervals) const { return double(n) * (double(n_intervals) * inv_n_max); }
+
+    /// Point k = 0, ..., n_intervals of the uniform grid of $[0,\beta]$ with n_intervals intervals
+    static tau_t grid_point(long k, long n_intervals) {
+      if (k == n_intervals) return beta();
+      return {uint64_t(k) * (n_max / uint64_t(n_intervals))};
+    }
+
     /// tau_t at tau = beta
     static tau_t beta() { return {uint64_t{n_max}}; }
 
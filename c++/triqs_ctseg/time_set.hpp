@@ -0,0 +1,96 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#pragma once
+#include <vector>
+#include "./tau_t.hpp"
+
+namespace triqs_ctseg {
+
+  /**
+   * A set of times with O(1) insertion, removal and lookup: open addressing with linear probing
+   * on a power of 2 table, indexed by the high bits of tau_t::hash, and deletion by backward shift
+   * (no tombstones). The table is kept at most half full.
+   *
+   * Used to check if a time is already in the det of a block (see work_data_t::c_times), without
+   * a binary search on the det.
+   */
+  class time_set_t {
+    std::vector<tau_t> slots;
+    std::vector<unsigned char> used; // used[i] iif slots[i] holds a time
+    long n    = 0;                   // Number of times in the set
+    int shift = 60;                  // Slot of tau = tau.hash() >> shift
+    long mask = 15;                  // Number of slots - 1
+
+    [[nodiscard]] long slot(tau_t const &tau) const { return long(tau.hash() >> shift); }
+
+    void rehash(long n_slots_log2) {
+      auto old_slots = std::move(slots);
+      auto old_used  = std::move(used);
+      shift          = 64 - int(n_slots_log2);
+      mask           = (long{1} << n_slots_log2) - 1;
+      slots.assign(mask + 1, tau_t{});
+      used.assign(mask + 1, 0);
+      n = 0;
+      for (long i = 0; i < long(old_slots.size()); ++i)
+        if (old_used[i]) insert(old_slots[i]);
+    }
+
+    public:
+    time_set_t() : slots(16), used(16, 0) {}
+
+    /// Number of times in the set
+    [[nodiscard]] long size() const { return n; }
+
+    /// Is tau in the set?
+    [[nodiscard]] bool contains(tau_t const &tau) const {
+      for (long i = slot(tau); used[i]; i = (i + 1) & mask)
+        if (slots[i] == tau) return true;
+      return false;
+    }
+
+    /// Add tau (no effect if already in the set)
+    void insert(tau_t const &tau) {
+      if (2 * (n + 1) > mask + 1) rehash(64 - shift + 1);
+      long i = slot(tau);
+      for (; used[i]; i = (i + 1) & mask)
+        if (slots[i] == tau) return;
+      slots[i] = tau;
+      used[i]  = 1;
+      ++n;
+    }
+
+    /// Remove tau (no effect if not in the set)
+    void erase(tau_t const &tau) {
+      long i = slot(tau);
+      for (; used[i]; i = (i + 1) & mask)
+        if (slots[i] == tau) break;
+      if (not used[i]) return;
+      // Move into the hole the following times of the cluster whose home slot is not between the hole and them
+      for (long j = (i + 1) & mask; used[j]; j = (j + 1) & mask) {
+        long home = slot(slots[j]);
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+          slots[i] = slots[j];
+          i        = j;
+        }
+      }
+      used[i] = 0;
+      --n;
+    }
+  };
+
+} // namespace triqs_ctseg
@@ -37,8 +37,10 @@ namespace triqs_ctseg {
     if constexpr (print_logs) spdlog::set_level(spdlog::level::debug);
 
     // Copy data from inputs
-    double beta = p.beta;
-    gf_struct   = p.gf_struct;
+    double beta        = p.beta;
+    gf_struct          = p.gf_struct;
+    delayed_acceptance = p.delayed_acceptance;
+    heat_bath_color    = p.heat_bath_color;
 
     // Count colors
     n_color = 0;
@@ -46,16 +48,16 @@ namespace triqs_ctseg {
 
     // Compute color/block conversion tables
     for (auto const &color : range(n_color)) {
-      block_number.push_back(find_block_number(color));
-      index_in_block.push_back(find_index_in_block(color));
+      gf_block_number.push_back(find_block_number(color));
+      gf_index_in_block.push_back(find_index_in_block(color));
     }
 
     // Print block/index/color correspondence
     if (c.rank() == 0) {
       spdlog::info("\n");
       for (auto const &color : range(n_color)) {
-        spdlog::info("Block: {}    Index: {}    Color: {}", gf_struct[block_number[color]].first, index_in_block[color],
-                     color);
+        spdlog::info("Block: {}    Index: {}    Color: {}", gf_struct[gf_block_number[color]].first,
+                     gf_index_in_block[color], color);
       }
     }
 
@@ -83,7 +85,8 @@ namespace triqs_ctseg {
     for (int c1 : range(n_color)) {
       for (int c2 : range(n_color)) {
         D0t.data()(range::all, c1, c2) =
-           inputs.D0t(block_number[c1], block_number[c2]).data()(range::all, index_in_block[c1], index_in_block[c2]);
+           inputs.D0t(gf_block_number[c1], gf_block_number[c2])
+              .data()(range::all, gf_index_in_block[c1], gf_index_in_block[c2]);
       }
     }
     // Symetrize
@@ -103,10 +106,11 @@ namespace triqs_ctseg {
     for (auto n : range(p.n_tau_bosonic)) { ramp(n) = n * beta / (p.n_tau_bosonic - 1); }
 
     // Dynamical interactions
+    gf<imtime> K_gf, Kprime_gf;
     if (has_Dt) {
       // Compute interaction kernels K(tau), K'(tau) by integrating D(tau)
-      K      = gf<imtime>({beta, Boson, p.n_tau_bosonic}, {n_color, n_color});
-      Kprime = K;
+      K_gf      = gf<imtime>({beta, Boson, p.n_tau_bosonic}, {n_color, n_color});
+      Kprime_gf = K_gf;
       for (auto c1 : range(n_color)) {
         for (auto c2 : range(n_color)) {
           nda::array<dcomplex, 1> D_data = D0t.data()(range::all, c1, c2);
@@ -121,13 +125,29 @@ namespace triqs_ctseg {
           first_integral *= beta / (p.n_tau_bosonic - 1);
           second_integral *= (beta / (p.n_tau_bosonic - 1)) * (beta / (p.n_tau_bosonic - 1));
           // Enforce K(0) = K(beta) = 0
-          Kprime.data()(range::all, c1, c2) = first_integral - second_integral(p.n_tau_bosonic - 1) / beta;
-          K.data()(range::all, c1, c2)      = second_integral - ramp * second_integral(p.n_tau_bosonic - 1) / beta;
+          Kprime_gf.data()(range::all, c1, c2) = first_integral - second_integral(p.n_tau_bosonic - 1) / beta;
+          K_gf.data()(range::all, c1, c2)      = second_integral - ramp * second_integral(p.n_tau_bosonic - 1) / beta;
           // Renormalize U and mu
-          if (c1 != c2) U(c1, c2) -= real(2 * Kprime.data()(0, c1, c2));
+          if (c1 != c2) U(c1, c2) -= real(2 * Kprime_gf.data()(0, c1, c2));
         }
-        mu(c1) += real(Kprime.data()(0, c1, c1));
+        mu(c1) += real(Kprime_gf.data()(0, c1, c1));
       }
+      K      = interp_table_t{K_gf};
+      Kprime = interp_table_t{Kprime_gf};
+      // Channel factorization of K, used for the retarded field if it has fewer channels than colors
+      ALWAYS_EXPECTS((p.use_K_field or not p.use_K_channels), "Error: use_K_channels requires use_K_field");
+      if (p.use_K_channels) {
+        K_channels = factorize_K(K_gf, p.K_channel_tolerance);
+        if (c.rank() == 0)
+          spdlog::info("Channel factorization of K(tau): {} channels, max error = {}", K_channels.n_channels(),
+                       K_channels.max_error);
+        use_K_channels = K_channels.n_channels() < n_color and K_channels.max_error < p.K_channel_tolerance;
+        if (not use_K_channels and c.rank() == 0)
+          spdlog::info("WARNING: K(tau) is not low-rank in color space, the channel factorization is not used");
+      }
+      // Retarded field, for the empty configuration
+      use_K_field = p.use_K_field;
+      if (use_K_field) K_field = K_field_t(use_K_channels ? K_channels.n_channels() : n_color, p.n_tau_bosonic);
     }
 
     // Jperp interactions
@@ -136,7 +156,8 @@ namespace triqs_ctseg {
       if (not has_Dt)
         rot_inv = false;
       else {
-        Kprime_spin = gf<imtime>({beta, Boson, p.n_tau_bosonic}, {n_color, n_color}); // used in computation of F(tau)
+        // Kprime_spin is used in the computation of F(tau)
+        auto Kprime_spin_gf = gf<imtime>({beta, Boson, p.n_tau_bosonic}, {n_color, n_color});
         // Integrate Jperp to obtain the S_z.S_z part of K'(tau) (called Kprime_spin)
         auto Kprime_J                  = Jperp;
         nda::array<dcomplex, 1> J_data = Jperp.data()(range::all, 0, 0);
@@ -152,11 +173,12 @@ namespace triqs_ctseg {
         // Kprime_spin = +/- Kprime_J depending on color
         for (auto c1 : range(n_color)) {
           for (auto c2 : range(n_color)) {
-            Kprime_spin.data()(range::all, c1, c2) = (c1 == c2 ? 1 : -1) * Kprime_J.data()(range::all, 0, 0) / 4;
+            Kprime_spin_gf.data()(range::all, c1, c2) = (c1 == c2 ? 1 : -1) * Kprime_J.data()(range::all, 0, 0) / 4;
           }
         }
+        Kprime_spin = interp_table_t{Kprime_spin_gf};
         auto Kprime_0 = gf<imtime>({beta, Boson, p.n_tau_bosonic}, {n_color, n_color});
-        Kprime_0      = Kprime - Kprime_spin;
+        Kprime_0      = Kprime_gf - Kprime_spin_gf;
         // The "remainder" Kprime_0 must be color-independent for there to be rotational invariance
         if (max_element(abs(Kprime_0.data()(range::all, 0, 0) - Kprime_0.data()(range::all, 0, 1))) > 1.e-13)
           rot_inv = false;
@@ -188,33 +210,86 @@ namespace triqs_ctseg {
       if (c.rank() == 0) { spdlog::info("Delta(tau) is 0, running only spin moves."); }
     }
 
-    // Does gf_struct allow for off-diagonal Delta?
-    for (auto const &[s, l] : gf_struct) {
-      if (l > 1) offdiag_Delta = true;
-    }
+    ALWAYS_EXPECTS((p.Delta_representation == "grid" or p.Delta_representation == "poles"),
+                   "Error: Delta_representation must be \"grid\" or \"poles\", got {}", p.Delta_representation);
 
     // Take the real part of Delta(tau)
     Delta = map([](gf_const_view<imtime> d) { return real(d); }, inputs.Delta);
-    for (auto const &bl : range(Delta.size())) {
-      // Construct the detmanip object for block bl
-      dets.emplace_back(Delta_block_adaptor{Delta[bl]}, p.det_init_size);
+
+    // Construct the detmanip object for Delta(tau) restricted to the colors of a det
+    auto make_det = [&](gf_const_view<imtime, matrix_real_valued> D) {
+      long size = D.target_shape()[0];
+      if (p.Delta_representation == "poles") {
+        auto poles = fit_Delta_poles(D, p.Delta_n_poles, p.Delta_pole_energy_max);
+        if (c.rank() == 0) spdlog::info("Det {}: pole fit of Delta(tau), max error = {}", dets.size(), poles.max_error);
+        if (poles.max_error < p.Delta_fit_tolerance)
+          dets.emplace_back(Delta_block_adaptor{std::move(poles), size}, p.det_init_size, p.det_n_delayed_updates,
+                            p.det_small_max_order);
+        else {
+          if (c.rank() == 0) spdlog::info("WARNING: Fit error above Delta_fit_tolerance, using the grid for Delta(tau)");
+          dets.emplace_back(Delta_block_adaptor{D}, p.det_init_size, p.det_n_delayed_updates, p.det_small_max_order);
+        }
+      } else
+        dets.emplace_back(Delta_block_adaptor{D}, p.det_init_size, p.det_n_delayed_updates, p.det_small_max_order);
       // Set parameters
       dets.back().set_singular_threshold(p.det_singular_threshold);
       dets.back().set_n_operations_before_check(p.det_n_operations_before_check);
       dets.back().set_precision_warning(p.det_precision_warning);
       dets.back().set_precision_error(p.det_precision_error);
+      if (p.det_adaptive_check) dets.back().enable_adaptive_check(p.det_n_operations_before_check);
+      sign_trackers.emplace_back(size);
+    };
+
+    // One det per block, or per connected component of the block if det_split_blocks
+    block_number.resize(n_color);
+    index_in_block.resize(n_color);
+    for (long offset = 0; auto const &bl : range(Delta.size())) {
+      long bl_size = gf_struct[bl].second;
+      std::vector<std::vector<long>> components;
+      if (p.det_split_blocks)
+        components = Delta_block_components(Delta[bl], p.det_split_tolerance);
+      else {
+        components.emplace_back(bl_size);
+        for (auto a : range(bl_size)) components[0][a] = a;
+      }
+      for (auto const &idx : components) {
+        long n = long(idx.size());
+        std::vector<int> colors(n);
+        for (auto k : range(n)) {
+          colors[k]                       = int(offset + idx[k]);
+          block_number[offset + idx[k]]   = long(dets.size());
+          index_in_block[offset + idx[k]] = k;
+        }
+        if (n == bl_size)
+          make_det(Delta[bl]);
+        else {
+          // Delta(tau) restricted to the component
+          auto D = gf<imtime, matrix_real_valued>{Delta[bl].mesh(), {n, n}};
+          for (auto k1 : range(n))
+            for (auto k2 : range(n)) D.data()(range::all, k1, k2) = Delta[bl].data()(range::all, idx[k1], idx[k2]);
+          make_det(D);
+        }
+        det_colors.push_back(std::move(colors));
+      }
+      offset += bl_size;
     }
-  } // work_data constructor
 
-  int work_data_t::block_to_color(int block, int idx) const {
-    std::vector<long> gf_block_size_partial_sum;
-    long acc = 0;
-    for (auto const &[s, l] : gf_struct) {
-      gf_block_size_partial_sum.push_back(acc);
-      acc += l;
+    // Print color/det correspondence
+    if (p.det_split_blocks and c.rank() == 0) {
+      spdlog::info("Dets of the connected components of Delta(tau): {} dets for {} blocks", dets.size(), Delta.size());
+      for (auto const &color : range(n_color))
+        spdlog::info("Color: {}    Det: {}    Index: {}", color, block_number[color], index_in_block[color]);
     }
-    return gf_block_size_partial_sum[block] + idx;
-  }
+
+    // Are there dets with off-diagonal Delta?
+    for (auto const &colors : det_colors) {
+      if (colors.size() > 1) offdiag_Delta = true;
+    }
+    if (offdiag_Delta) {
+      c_times.resize(dets.size());
+      cdag_times.resize(dets.size());
+    }
+  } // work_data constructor
 
   long work_data_t::find_block_number(int color) const {
     long bl            = 0;
@@ -238,6 +313,22 @@ namespace triqs_ctseg {
     return 0;
   }
 
+  double work_data_t::record_insert(long bl, std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y) {
+    if (offdiag_Delta) {
+      cdag_times[bl].insert(x.first);
+      c_times[bl].insert(y.first);
+    }
+    return sign_trackers[bl].insert(x, y);
+  }
+
+  double work_data_t::record_remove(long bl, std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y) {
+    if (offdiag_Delta) {
+      cdag_times[bl].erase(x.first);
+      c_times[bl].erase(y.first);
+    }
+    return sign_trackers[bl].remove(x, y);
+  }
+
   // Additional sign of the trace (computed from dets).
   double trace_sign(work_data_t const &wdata) {
     double sign      = 1.0;
@@ -251,7 +342,7 @@ namespace triqs_ctseg {
     // to the increasing time-and-color-ordered list of operators.
     for (auto bl : range(dets.size())) {
       auto s              = long(dets[bl].size());
-      auto n_colors_in_bl = wdata.gf_struct[bl].second;
+      auto n_colors_in_bl = long(wdata.det_colors[bl].size());
       std::vector<int> number_c_before(n_colors_in_bl, 0);
       std::vector<int> number_cdag_before(n_colors_in_bl, 0);
       if (s != 0) {
@@ -314,19 +405,4 @@ namespace triqs_ctseg {
     return sign;
   } // sign computation
 
-  // Functions for checking if a time is already in det.
-  bool c_in_det(tau_t const &tau, det_t const &D) {
-    if (D.size() == 0) return false;
-    auto det_c_time  = [&](long i) { return D.get_y(i).first; };
-    long det_index_c = lower_bound(det_c_time, D.size(), tau);
-    return (det_index_c >= D.size()) ? false : (det_c_time(det_index_c) == tau);
-  }
-
-  bool cdag_in_det(tau_t const &tau, det_t const &D) {
-    if (D.size() == 0) return false;
-    auto det_cdag_time  = [&](long i) { return D.get_x(i).first; };
-    long det_index_cdag = lower_bound(det_cdag_time, D.size(), tau);
-    return (det_index_cdag >= D.size()) ? false : (det_cdag_time(det_index_cdag) == tau);
-  }
-
 } // namespace triqs_ctseg
@@ -24,6 +24,10 @@
 #include "inputs.hpp"
 #include "util.hpp"
 #include "dets.hpp"
+#include "K_field.hpp"
+#include "K_channels.hpp"
+#include "sign_tracker.hpp"
+#include "time_set.hpp"
 
 namespace triqs_ctseg {
 
@@ -36,43 +40,95 @@ namespace triqs_ctseg {
     int n_color;            // Number of colors
     nda::vector<double> mu; // Chemical potential per color
 
-    bool has_Delta     = false; // There is a non-zero hybridization term
-    bool has_Dt        = false; // There is a non-zero dynamical nn interaction
-    bool has_Jperp     = false; // There is a non-zero Jperp interaction
-    bool rot_inv       = true;  // The spin-spin interaction is rotationally invariant (matters for F(tau) measure)
-    bool minus_sign    = false; // Has a move ever produced a negative sign?
-    bool offdiag_Delta = false; // Does Delta(tau) have blocks of size larger than 1?
+    bool has_Delta      = false; // There is a non-zero hybridization term
+    bool has_Dt         = false; // There is a non-zero dynamical nn interaction
+    bool has_Jperp      = false; // There is a non-zero Jperp interaction
+    bool rot_inv        = true;  // The spin-spin interaction is rotationally invariant (matters for F(tau) measure)
+    bool minus_sign     = false; // Has a move ever produced a negative sign?
+    bool offdiag_Delta  = false; // Is there a det of size larger than 1?
+    bool use_K_field    = false; // Are the K overlaps in the moves computed from the retarded field?
+    bool use_K_channels = false; // Are the K overlaps in the moves computed in the channels of K?
 
-    // Dynamical and spin-spin interaction kernels
-    gf<imtime> D0t, K, Kprime, Jperp, Kprime_spin;
+    // Two-stage acceptance: the moves first accept with probability min(1, |trace ratio x proposal ratio|), and only
+    // then compute the det ratio, which they return (with the sign of the first stage) for the second stage in
+    // mc_generic. See params_t.
+    bool delayed_acceptance = false;
+
+    // Heat-bath choice of the color in insert_segment and split_segment (and the reverse ratios). See params_t.
+    bool heat_bath_color = false;
+
+    // Dynamical and spin-spin interactions
+    gf<imtime> D0t, Jperp;
+
+    // Interaction kernels K_{c1 c2}(tau), K'_{c1 c2}(tau) and the spin part of K', real part.
+    // Contiguous tables evaluated by linear interpolation, see interpolation.hpp
+    interp_table_t K, Kprime, Kprime_spin;
+
+    // Channel factorization of K, if use_K_channels. See K_channels.hpp
+    K_channels_t K_channels;
+
+    // Retarded field of K for the current configuration, if use_K_field (one per channel if use_K_channels).
+    // See K_field.hpp
+    K_field_t K_field;
 
     // Hybridization function
     block_gf<imtime, matrix_real_valued> Delta;
 
     // The determinants
-    // Vector of the det_manip objects, one per block of the input Delta(tau). See dets.hpp
+    // Vector of the det_manip objects, one per block of the input Delta(tau), or one per connected component of the
+    // blocks if det_split_blocks. See dets.hpp
     std::vector<det_t> dets;
 
-    // Color to (block, idx) conversion tables
-    std::vector<long> block_number;   // block numbers corresponding to colors
-    std::vector<long> index_in_block; // index in block of a given color
-
-    // Find color corresponding to (block, idx)
-    int block_to_color(int block, int idx) const;
-
-    // Find block of color
+    // Incremental sign of the trace, one per block. Updated with the dets in the accept of the moves.
+    // See sign_tracker.hpp
+    std::vector<sign_tracker_t> sign_trackers;
+
+    // Times of the c and cdag in the det of each block, if offdiag_Delta (to reject coinciding times in O(1)).
+    // See time_set.hpp
+    std::vector<time_set_t> c_times, cdag_times;
+
+    // Color to (det, idx) conversion tables, used with the dets.
+    // Without det_split_blocks, the dets are the blocks of gf_struct.
+    std::vector<long> block_number;   // det numbers corresponding to colors
+    std::vector<long> index_in_block; // index in det of a given color
+    std::vector<std::vector<int>> det_colors; // colors of each det, in increasing order
+
+    // Color to (block, idx) conversion tables of gf_struct, used with the inputs and results
+    std::vector<long> gf_block_number;   // block numbers corresponding to colors
+    std::vector<long> gf_index_in_block; // index in block of a given color
+
+    // Update the retarded field (if used) when a c at tau_c and a cdag at tau_cdag are added (sign = 1)
+    // or removed (sign = -1) in color. Called in the accept of the moves.
+    void update_K_field(int color, tau_t const &tau_c, tau_t const &tau_cdag, double sign) {
+      if (use_K_field) K_field.add_segment(K_field_table(), color, tau_c, tau_cdag, sign);
+    }
+
+    // The table the retarded field is built from
+    [[nodiscard]] interp_table_t const &K_field_table() const { return use_K_channels ? K_channels.K_v : K; }
+
+    // Record the insertion (removal) of a cdag x and a c y in the det of block bl, once the det operation is
+    // completed, in the sign tracker and time sets of the block. Returns the ratio of the new to the old trace sign.
+    double record_insert(long bl, std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y);
+    double record_remove(long bl, std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y);
+
+    // Sign of the trace, from the sign trackers (equal to trace_sign(*this))
+    [[nodiscard]] double tracked_trace_sign() const {
+      double sign = 1.0;
+      for (auto const &t : sign_trackers) sign *= t.sign();
+      return sign;
+    }
+
+    // Find color corresponding to (det, idx)
+    int block_to_color(int block, int idx) const { return det_colors[block][idx]; }
+
+    // Find block of color in gf_struct
     long find_block_number(int color) const;
 
-    // Find index of color in its block
+    // Find index of color in its block of gf_struct
     long find_index_in_block(int color) const;
   };
 
   // Additional sign of the trace (computed from dets).
   double trace_sign(work_data_t const &wdata);
 
-  // Functions for checking if a time is already in det.
-  bool c_in_det(tau_t const &tau, det_t const &D);
-
-  bool cdag_in_det(tau_t const &tau, det_t const &D);
-
 } // namespace triqs_ctseg
@@ -46,11 +46,36 @@ c.add_member(c_name = "F_tau",
              read_only= True,
              doc = r"""Self-energy improved estimator :math:`F(\tau)`.""")
 
+c.add_member(c_name = "G_l",
+             c_type = "std::optional<block_gf<legendre>>",
+             read_only= True,
+             doc = r"""Legendre coefficients :math:`G_l` of the Green's function.""")
+
+c.add_member(c_name = "F_l",
+             c_type = "std::optional<block_gf<legendre>>",
+             read_only= True,
+             doc = r"""Legendre coefficients :math:`F_l` of the self-energy improved estimator.""")
+
+c.add_member(c_name = "G_iw",
+             c_type = "std::optional<block_gf<imfreq>>",
+             read_only= True,
+             doc = r"""Green's function :math:`G(i\omega_n)`, measured directly in Matsubara frequencies.""")
+
+c.add_member(c_name = "F_iw",
+             c_type = "std::optional<block_gf<imfreq>>",
+             read_only= True,
+             doc = r"""Self-energy improved estimator :math:`F(i\omega_n)`, measured directly in Matsubara frequencies.""")
+
 c.add_member(c_name = "nn_tau",
              c_type = "std::optional<block2_gf<imtime>>",
              read_only= True,
              doc = r"""Density-density time correlation function :math:`\langle n_a(\tau) n_b(0) \rangle`.""")
 
+c.add_member(c_name = "nn_iw",
+             c_type = "std::optional<block2_gf<imfreq>>",
+             read_only= True,
+             doc = r"""Density-density correlation function in Matsubara frequencies :math:`\langle n_a(\tau) n_b(0) \rangle(i\nu)`.""")
+
 c.add_member(c_name = "Sperp_tau",
              c_type = "std::optional<gf<imtime>>",
              read_only= True,
@@ -101,6 +126,26 @@ c.add_member(c_name = "f3w",
              read_only= True,
              doc = r"""Four-point correlation function improved estimator""")
 
+c.add_member(c_name = "det_check_interval",
+             c_type = "std::optional<nda::vector<long>>",
+             read_only= True,
+             doc = r"""Interval between two det checks at the end of the run, per det (minimum over the nodes, det_adaptive_check)""")
+
+c.add_member(c_name = "det_max_drift",
+             c_type = "std::optional<nda::vector<double>>",
+             read_only= True,
+             doc = r"""Largest deviation of the det inverse found by the checks, per det (det_adaptive_check)""")
+
+c.add_member(c_name = "move_weights",
+             c_type = "std::optional<std::map<std::string, double>>",
+             read_only= True,
+             doc = r"""Proposal weights of the moves after tuning, averaged over the nodes (n_tuning_cycles > 0)""")
+
+c.add_member(c_name = "move_acceptance_rates",
+             c_type = "std::optional<std::map<std::string, double>>",
+             read_only= True,
+             doc = r"""Acceptance rate of each move over the whole run, on all nodes (n_tuning_cycles > 0)""")
+
 c.add_member(c_name = "average_sign",
              c_type = "double",
              read_only= True,
@@ -166,8 +211,14 @@ c.add_method("""void solve (**solve_params_t)""",
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | n_tau_G                       | int                                  | 0                                       | Number of points on which to measure G(tau)/F(tau) (defaults to n_tau)                                            |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| n_legendre_G                  | int                                  | 50                                      | Number of Legendre coefficients of G_l/F_l                                                                        |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| n_iw_G                        | int                                  | 500                                     | Number of positive fermionic Matsubara frequencies of G_iw/F_iw                                                   |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | n_tau_chi2                    | int                                  | 0                                       | Number of points on which to measure 2-point functions (defaults to n_tau_bosonic)                                |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| n_iw_chi2                     | int                                  | 100                                     | Number of non-negative bosonic Matsubara frequencies on which to measure nn_iw                                    |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | n_w_b_vertex                  | int                                  | 10                                      | Number of bosonic M-frequency points on which to measure vertex functions                                         |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | n_w_f_vertex                  | int                                  | 10                                      | Number of fermionic M-frequency points on which to measure vertex functions                                       |
@@ -206,12 +257,32 @@ c.add_method("""void solve (**solve_params_t)""",
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | move_swap_spin_lines          | bool                                 | true                                    | Whether to perform the move swap spin lines                                                                       |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| move_shift_segment_end        | bool                                 | false                                   | Whether to perform the move shift segment end (shift a single c or cdag of a segment)                             |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| color_permutations            | std::vector<std::vector<long>>       | {}                                      | Color permutations (new color of each color) for the move permute colors. Symmetries of mu, U and D0(tau)         |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| move_weights                  | std::map<std::string, double>        | {}                                      | Proposal weights of the moves by name ("insert", "spin split", ...), default 1. Equal for a move and its inverse  |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| n_tuning_cycles               | int                                  | 0                                       | Number of warmup cycles at the start of the warmup used to tune the move weights (0: no tuning)                   |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| delayed_acceptance            | bool                                 | false                                   | Two-stage acceptance: reject from the trace and proposal ratios first, before computing the det ratio             |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| heat_bath_color               | bool                                 | false                                   | Heat-bath choice of the color in insert/remove and split/regroup segment, for the times drawn uniformly           |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | measure_pert_order            | bool                                 | true                                    | Whether to measure the perturbation order histograms (order in Delta and Jperp)                                   |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | measure_G_tau                 | bool                                 | true                                    | Whether to measure G(tau) (see measures/G_F_tau)                                                                  |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | measure_F_tau                 | bool                                 | false                                   | Whether to measure F(tau) (see measures/G_F_tau)                                                                  |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| measure_G_l                   | bool                                 | false                                   | Whether to measure G_l, the Legendre coefficients of G(tau) (see measures/G_F_l)                                  |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| measure_F_l                   | bool                                 | false                                   | Whether to measure F_l, the Legendre coefficients of F(tau), along with G_l (see measures/G_F_l)                  |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| measure_G_iw                  | bool                                 | false                                   | Whether to measure G(iw) directly, by a non-uniform Fourier transform of the det entries (see measures/G_F_iw)    |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| measure_F_iw                  | bool                                 | false                                   | Whether to measure F(iw) as well, along with G(iw) (see measures/G_F_iw)                                          |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | measure_densities             | bool                                 | true                                    | Whether to measure densities (see measures/densities)                                                             |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | measure_average_sign          | bool                                 | true                                    | Whether to measure the average sign (see measures/average_sign)                                                   |
@@ -220,6 +291,10 @@ c.add_method("""void solve (**solve_params_t)""",
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | measure_nn_tau                | bool                                 | false                                   | Whether to measure <n(tau)n(0)> (see measures/nn_tau)                                                             |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| nn_tau_average                | bool                                 | false                                   | Measure <n(tau)n(0)> averaged over the reference time (improved estimator, O(n_ops^2) per measure)                |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| measure_nn_iw                 | bool                                 | false                                   | Whether to measure <n(i nu)n(-i nu)> (see measures/nn_iw)                                                         |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | measure_Sperp_tau             | bool                                 | false                                   | Whether to measure <S_x(tau)S_x(0)> (see measures/Sperp_tau)                                                      |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | measure_state_hist            | bool                                 | false                                   | Whether to measure state histograms (see measures/state_hist)                                                     |
@@ -228,16 +303,40 @@ c.add_method("""void solve (**solve_params_t)""",
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | measure_f3w                   | bool                                 | false                                   | Whether to measure four-point correlation function improved estimator (see measures/four_point)                   |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| use_K_field                   | bool                                 | false                                   | Compute the K(tau) overlaps in the moves from an incrementally updated retarded field (see K_field.hpp)           |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| use_K_channels                | bool                                 | false                                   | Store the retarded field of K(tau) in a few color channels if K(tau) is low-rank (needs use_K_field)              |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| K_channel_tolerance           | double                               | 1.e-10                                  | Maximum error of the channel factorization of K(tau)                                                              |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | det_init_size                 | int                                  | 100                                     | The maximum size of the determinant matrix before a resize                                                        |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | det_n_operations_before_check | int                                  | 100                                     | Max number of ops before the test of deviation of the det, M^-1 is performed.                                     |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| det_adaptive_check            | bool                                 | false                                   | Adapt the interval between two det checks to the measured deviation (det_n_operations_before_check is the first)  |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | det_precision_warning         | double                               | 1.e-8                                   | Threshold for determinant precision warnings                                                                      |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | det_precision_error           | double                               | 1.e-5                                   | Threshold for determinant precision error                                                                         |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | det_singular_threshold        | double                               | -1                                      | Bound for the determinant matrix being singular, abs(det) > singular_threshold. If <0, it is !isnormal(abs(det))  |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| det_n_delayed_updates         | int                                  | 0                                       | Number of accepted updates of a det applied at once as a rank-k update of its inverse (0: rank-1 updates)         |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| det_small_max_order           | int                                  | 0                                       | Dets of order at most this use inline storage, tuned for small orders (0: none). See det_t in dets.hpp            |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| det_split_blocks              | bool                                 | false                                   | Split the blocks into the connected components of the off-diagonal structure of Delta(tau), with one det each     |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| det_split_tolerance           | double                               | 1.e-13                                  | Off-diagonal elements of Delta(tau) below this are treated as zero when splitting the blocks (det_split_blocks)   |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| Delta_representation          | std::string                          | "grid"                                  | Representation of Delta(tau) in the dets: "grid" (interpolation on its mesh) or "poles" (sum of exponentials)     |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| Delta_n_poles                 | int                                  | 61                                      | Number of poles for the fit of Delta(tau) (Delta_representation = "poles")                                        |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| Delta_pole_energy_max         | double                               | 20.0                                    | Largest pole energy for the fit of Delta(tau) (Delta_representation = "poles")                                    |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
+| Delta_fit_tolerance           | double                               | 1.e-6                                   | Maximum error of the pole fit of Delta(tau) on its mesh, above which the grid representation is used              |
++-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 | histogram_max_order           | int                                  | 1000                                    | Maximum order for the perturbation order histograms                                                               |
 +-------------------------------+--------------------------------------+-----------------------------------------+-------------------------------------------------------------------------------------------------------------------+
 """)
@@ -277,11 +376,26 @@ c.add_member(c_name = "n_tau_G",
              initializer = """ 0 """,
              doc = r"""Number of points on which to measure G(tau)/F(tau) (defaults to n_tau)""")
 
+c.add_member(c_name = "n_legendre_G",
+             c_type = "int",
+             initializer = """ 50 """,
+             doc = r"""Number of Legendre coefficients of G_l/F_l""")
+
+c.add_member(c_name = "n_iw_G",
+             c_type = "int",
+             initializer = """ 500 """,
+             doc = r"""Number of positive fermionic Matsubara frequencies of G_iw/F_iw""")
+
 c.add_member(c_name = "n_tau_chi2",
              c_type = "int",
              initializer = """ 0 """,
              doc = r"""Number of points on which to measure 2-point functions (defaults to n_tau_bosonic)""")
 
+c.add_member(c_name = "n_iw_chi2",
+             c_type = "int",
+             initializer = """ 100 """,
+             doc = r"""Number of non-negative bosonic Matsubara frequencies on which to measure nn_iw""")
+
 c.add_member(c_name = "n_w_b_vertex",
              c_type = "int",
              initializer = """ 10 """,
@@ -377,6 +491,36 @@ c.add_member(c_name = "move_swap_spin_lines",
              initializer = """ true """,
              doc = r"""Whether to perform the move swap spin lines""")
 
+c.add_member(c_name = "move_shift_segment_end",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Whether to perform the move shift segment end (shift a single c or cdag of a segment)""")
+
+c.add_member(c_name = "color_permutations",
+             c_type = "std::vector<std::vector<long>>",
+             initializer = """ {} """,
+             doc = r"""Color permutations (new color of each color) for the move permute colors. Symmetries of mu, U and D0(tau)""")
+
+c.add_member(c_name = "move_weights",
+             c_type = "std::map<std::string, double>",
+             initializer = """ {} """,
+             doc = r"""Proposal weights of the moves by name ("insert", "spin split", ...), default 1. Equal for a move and its inverse""")
+
+c.add_member(c_name = "n_tuning_cycles",
+             c_type = "int",
+             initializer = """ 0 """,
+             doc = r"""Number of warmup cycles at the start of the warmup used to tune the move weights (0: no tuning)""")
+
+c.add_member(c_name = "delayed_acceptance",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Two-stage acceptance: reject from the trace and proposal ratios first, before computing the det ratio""")
+
+c.add_member(c_name = "heat_bath_color",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Heat-bath choice of the color in insert/remove and split/regroup segment, for the times drawn uniformly""")
+
 c.add_member(c_name = "measure_pert_order",
              c_type = "bool",
              initializer = """ true """,
@@ -392,6 +536,26 @@ c.add_member(c_name = "measure_F_tau",
              initializer = """ false """,
              doc = r"""Whether to measure F(tau) (see measures/G_F_tau)""")
 
+c.add_member(c_name = "measure_G_l",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Whether to measure G_l, the Legendre coefficients of G(tau) (see measures/G_F_l)""")
+
+c.add_member(c_name = "measure_F_l",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Whether to measure F_l, the Legendre coefficients of F(tau), along with G_l (see measures/G_F_l)""")
+
+c.add_member(c_name = "measure_G_iw",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Whether to measure G(iw) directly, by a non-uniform Fourier transform of the det entries (see measures/G_F_iw)""")
+
+c.add_member(c_name = "measure_F_iw",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Whether to measure F(iw) as well, along with G(iw) (see measures/G_F_iw)""")
+
 c.add_member(c_name = "measure_densities",
              c_type = "bool",
              initializer = """ true """,
@@ -412,6 +576,16 @@ c.add_member(c_name = "measure_nn_tau",
              initializer = """ false """,
              doc = r"""Whether to measure <n(tau)n(0)> (see measures/nn_tau)""")
 
+c.add_member(c_name = "nn_tau_average",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Measure <n(tau)n(0)> averaged over the reference time (improved estimator, O(n_ops^2) per measure)""")
+
+c.add_member(c_name = "measure_nn_iw",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Whether to measure <n(i nu)n(-i nu)> (see measures/nn_iw)""")
+
 c.add_member(c_name = "measure_Sperp_tau",
              c_type = "bool",
              initializer = """ false """,
@@ -432,6 +606,21 @@ c.add_member(c_name = "measure_f3w",
              initializer = """ false """,
              doc = r"""Whether to measure four-point correlation function improved estimator (see measures/four_point)""")
 
+c.add_member(c_name = "use_K_field",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Compute the K(tau) overlaps in the moves from an incrementally updated retarded field (see K_field.hpp)""")
+
+c.add_member(c_name = "use_K_channels",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Store the retarded field of K(tau) in a few color channels if K(tau) is low-rank (needs use_K_field)""")
+
+c.add_member(c_name = "K_channel_tolerance",
+             c_type = "double",
+             initializer = """ 1.e-10 """,
+             doc = r"""Maximum error of the channel factorization of K(tau)""")
+
 c.add_member(c_name = "det_init_size",
              c_type = "int",
              initializer = """ 100 """,
@@ -442,6 +631,11 @@ c.add_member(c_name = "det_n_operations_before_check",
              initializer = """ 100 """,
              doc = r"""Max number of ops before the test of deviation of the det, M^-1 is performed.""")
 
+c.add_member(c_name = "det_adaptive_check",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Adapt the interval between two det checks to the measured deviation (det_n_operations_before_check is the first)""")
+
 c.add_member(c_name = "det_precision_warning",
              c_type = "double",
              initializer = """ 1.e-8 """,
@@ -457,6 +651,46 @@ c.add_member(c_name = "det_singular_threshold",
              initializer = """ -1 """,
              doc = r"""Bound for the determinant matrix being singular, abs(det) > singular_threshold. If <0, it is !isnormal(abs(det))""")
 
+c.add_member(c_name = "det_n_delayed_updates",
+             c_type = "int",
+             initializer = """ 0 """,
+             doc = r"""Number of accepted updates of a det applied at once as a rank-k update of its inverse (0: rank-1 updates)""")
+
+c.add_member(c_name = "det_small_max_order",
+             c_type = "int",
+             initializer = """ 0 """,
+             doc = r"""Dets of order at most this use inline storage, tuned for small orders (0: none). See det_t in dets.hpp""")
+
+c.add_member(c_name = "det_split_blocks",
+             c_type = "bool",
+             initializer = """ false """,
+             doc = r"""Split the blocks into the connected components of the off-diagonal structure of Delta(tau), with one det each""")
+
+c.add_member(c_name = "det_split_tolerance",
+             c_type = "double",
+             initializer = """ 1.e-13 """,
+             doc = r"""Off-diagonal elements of Delta(tau) below this are treated as zero when splitting the blocks (det_split_blocks)""")
+
+c.add_member(c_name = "Delta_representation",
+             c_type = "std::string",
+             initializer = """ "grid" """,
+             doc = r"""Representation of Delta(tau) in the dets: "grid" (interpolation on its mesh) or "poles" (sum of exponentials)""")
+
+c.add_member(c_name = "Delta_n_poles",
+             c_type = "int",
+             initializer = """ 61 """,
+             doc = r"""Number of poles for the fit of Delta(tau) (Delta_representation = "poles")""")
+
+c.add_member(c_name = "Delta_pole_energy_max",
+             c_type = "double",
+             initializer = """ 20.0 """,
+             doc = r"""Largest pole energy for the fit of Delta(tau) (Delta_representation = "poles")""")
+
+c.add_member(c_name = "Delta_fit_tolerance",
+             c_type = "double",
+             initializer = """ 1.e-6 """,
+             doc = r"""Maximum error of the pole fit of Delta(tau) on its mesh, above which the grid representation is used""")
+
 c.add_member(c_name = "histogram_max_order",
              c_type = "int",
              initializer = """ 1000 """,
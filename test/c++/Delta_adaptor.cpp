@@ -0,0 +1,71 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <random>
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs_ctseg/dets.hpp>
+
+using namespace triqs_ctseg;
+
+// Previous implementation of the adaptor, through the generic gf evaluator.
+struct Delta_gf_adaptor {
+  gf<imtime, matrix_real_valued> Delta;
+
+  double operator()(std::pair<tau_t, int> const &x, std::pair<tau_t, int> const &y) const {
+    double res = Delta(double(x.first - y.first))(x.second, y.second);
+    return (x.first >= y.first ? res : -res);
+  }
+};
+
+TEST(Delta_adaptor, accuracy) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+
+  auto Delta = gf<imtime, matrix_real_valued>{{beta, Fermion, 10001}, {2, 2}};
+  for (auto t : Delta.mesh()) {
+    double tau     = t.value();
+    Delta[t](0, 0) = -0.5 * (std::exp(-tau) + std::exp(-(beta - tau)));
+    Delta[t](1, 1) = -0.3 * std::cosh(0.5 * (tau - beta / 2)) / std::cosh(0.25 * beta);
+    Delta[t](0, 1) = 0.1 * std::sin(M_PI * tau / beta);
+    Delta[t](1, 0) = Delta[t](0, 1);
+  }
+
+  auto table = Delta_block_adaptor{Delta};
+  auto ref   = Delta_gf_adaptor{Delta};
+
+  // Random (tau, index) pairs
+  long N = 200000;
+  std::mt19937_64 rng(42);
+  std::vector<std::pair<tau_t, int>> xs, ys;
+  for (long n = 0; n < N; ++n) {
+    xs.emplace_back(tau_t{uint64_t{rng()}}, int(rng() % 2));
+    ys.emplace_back(tau_t{uint64_t{rng()}}, int(rng() % 2));
+  }
+
+  // Same values, up to rounding
+  double max_diff = 0;
+  for (long n = 0; n < N; ++n) max_diff = std::max(max_diff, std::abs(table(xs[n], ys[n]) - ref(xs[n], ys[n])));
+  EXPECT_NEAR(max_diff, 0, 1.e-13);
+
+  // The batched row evaluation agrees with the scalar one
+  std::vector<double> row(1000);
+  table.fill_row(xs[0], 1000, [&](long n) { return ys[n]; }, row.data());
+  for (long n = 0; n < 1000; ++n) EXPECT_EQ(row[n], table(xs[0], ys[n]));
+  std::vector<double> col(1000);
+  table.fill_col(1000, [&](long n) { return xs[n]; }, ys[0], col.data());
+  for (long n = 0; n < 1000; ++n) EXPECT_EQ(col[n], table(xs[n], ys[0]));
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <random>
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs_ctseg/dets.hpp>
+
+using namespace triqs_ctseg;
+
+// Hybridization with a discrete bath
+double Delta_bath(double tau, double beta, std::vector<double> const &eps, std::vector<double> const &V) {
+  double res = 0;
+  for (auto i : range(eps.size())) {
+    double e = eps[i];
+    res -= V[i] * V[i] * (e > 0 ? std::exp(-e * tau) / (1 + std::exp(-beta * e)) : std::exp(e * (beta - tau)) / (1 + std::exp(beta * e)));
+  }
+  return res;
+}
+
+TEST(Delta_poles, fit) {
+  double beta = 10;
+  tau_t::set_beta(beta);
+  // Bath energies not on the grid of poles
+  auto eps = std::vector<double>{-1.3, 0.47, 2.2};
+  auto V   = std::vector<double>{0.5, 0.8, 0.3};
+
+  auto Delta = gf<imtime, matrix_real_valued>{{beta, Fermion, 10001}, {1, 1}};
+  for (auto t : Delta.mesh()) Delta[t](0, 0) = Delta_bath(t.value(), beta, eps, V);
+
+  // Default parameters of the solver
+  double tolerance = 1.e-6;
+  auto poles       = fit_Delta_poles(Delta, 61, 20.0);
+  EXPECT_LT(poles.max_error, tolerance);
+  EXPECT_LT(long(poles.kept.size()), poles.n_poles());
+
+  // The exponentials computed by squaring agree with std::exp (the relative rounding error doubles at each squaring)
+  auto x_exp = std::vector<double>(poles.n_poles());
+  for (double t : {0.0, 1.e-3, 2.5, 9.999, beta}) {
+    poles.exponentials(t, x_exp.data());
+    for (long p = 0; p < poles.n_poles(); ++p)
+      EXPECT_NEAR(x_exp[p], std::exp(-poles.energies[p] * (t - poles.shifts[p])), 1.e-10);
+  }
+
+  // The adaptor with poles agrees with the exact function, away from the mesh points
+  auto adaptor = Delta_block_adaptor{poles, 1};
+  std::mt19937_64 rng(1);
+  for (int n = 0; n < 1000; ++n) {
+    auto x = std::pair{tau_t{uint64_t{rng()}}, 0};
+    auto y = std::pair{tau_t{uint64_t{rng()}}, 0};
+    double d = Delta_bath(double(x.first - y.first), beta, eps, V);
+    EXPECT_NEAR(adaptor(x, y), (x.first >= y.first ? d : -d), tolerance);
+  }
+
+  // Too few poles: the fit error is reported
+  EXPECT_GT(fit_Delta_poles(Delta, 5, 20.0).max_error, tolerance);
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <random>
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs_ctseg/measures/G_F_iw.hpp>
+
+using namespace triqs_ctseg;
+using namespace triqs_ctseg::measures;
+
+// The non-uniform Fourier transform of G_F_iw against the exact sum, with random times in ]-beta, beta], times at
+// the edges, and times on the grid
+TEST(G_F_iw, nufft) {
+  double beta = 10;
+  int n_iw    = 100;
+  auto nufft  = fermionic_nufft_t{beta, n_iw};
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> u(-1, 1);
+  std::vector<double> taus;
+  for (int k = 0; k < 500; ++k) taus.push_back(beta * u(rng));
+  double eps = 1.e-12 * beta, h = beta / nufft.n_grid;
+  for (double t : {0.0, eps, -eps, h, -h, beta / 2, -beta / 2, beta - h, -beta + h, beta - eps, -beta + eps, beta})
+    taus.push_back(t);
+  std::vector<dcomplex> values;
+  double sum_abs = 0;
+  for ([[maybe_unused]] auto t : taus) {
+    values.emplace_back(u(rng), u(rng));
+    sum_abs += std::abs(values.back());
+  }
+
+  auto grid = nda::zeros<dcomplex>(nufft.n_grid, 1, 1);
+  for (auto k : range(taus.size())) nufft.spread(taus[k], values[k], [&](long m, dcomplex w) { grid(m, 0, 0) += w; });
+
+  for (long n = -n_iw; n < n_iw; ++n) {
+    dcomplex exact = 0;
+    for (auto k : range(taus.size())) exact += values[k] * std::exp(dcomplex(0, (2 * n + 1) * M_PI * taus[k] / beta));
+    EXPECT_COMPLEX_NEAR(nufft.transform(grid, n)(0, 0), exact, 1.e-10 * sum_abs);
+  }
+}
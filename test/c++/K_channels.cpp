@@ -0,0 +1,83 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <random>
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs_ctseg/configuration.hpp>
+#include <triqs_ctseg/K_channels.hpp>
+#include <triqs_ctseg/K_field.hpp>
+#include "./test_utils.hpp"
+
+using namespace triqs_ctseg;
+
+// K(tau) = f_charge(tau) for all colors + f_spin(tau) +/- depending on the spins
+gf<imtime> make_K(double beta, int n_color, long n_tau, double spin_amplitude) {
+  auto K = gf<imtime>({beta, Boson, n_tau}, {n_color, n_color});
+  for (auto t : K.mesh()) {
+    double tau = t.value();
+    double fc  = std::sinh(0.3 * tau) * std::sinh(0.3 * (beta - tau)) / 100;
+    double fs  = tau * (beta - tau) / 50;
+    for (int a = 0; a < n_color; ++a)
+      for (int b = 0; b < n_color; ++b) K[t](a, b) = fc + spin_amplitude * ((a % 2 == b % 2) ? fs : -fs);
+  }
+  return K;
+}
+
+TEST(K_channels, charge_channel) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  int n_color = 10;
+  long n_tau  = 2001;
+  auto K      = make_K(beta, n_color, n_tau, 0);
+  auto ch     = factorize_K(K, 1.e-10);
+  EXPECT_EQ(ch.n_channels(), 1);
+  EXPECT_LT(ch.max_error, 1.e-10);
+
+  // The channel overlaps reproduce the overlaps of the color pairs
+  std::mt19937_64 rng(7);
+  auto K_table = interp_table_t{K};
+  std::vector<seglist_t> seglists;
+  for (int c = 0; c < n_color; ++c) seglists.push_back(random_seglist(rng, 10));
+
+  // The field of the channels, as used in the solver, on a fine grid to reduce its interpolation error
+  auto field = K_field_t{ch.n_channels(), 100001};
+  field.reset(ch.K_v, seglists);
+
+  for (int n = 0; n < 20; ++n) {
+    auto tc = tau_t{rng()}, tcd = tau_t{rng()};
+    for (int c1 = 0; c1 < n_color; ++c1) {
+      double exact = 0, channel = 0, channel_field = 0;
+      for (int c2 = 0; c2 < n_color; ++c2) exact += K_overlap(seglists[c2], tc, tcd, K_table, c1, c2);
+      for (long k = 0; k < ch.n_channels(); ++k) {
+        for (int c2 = 0; c2 < n_color; ++c2)
+          channel += ch.u(k, c1) * K_overlap(seglists[c2], tc, tcd, ch.K_v, int(k), c2);
+        channel_field += ch.u(k, c1) * field.overlap(int(k), tc, tcd);
+      }
+      EXPECT_NEAR(channel, exact, 1.e-10 * (1 + std::abs(exact)));
+      EXPECT_NEAR(channel_field, exact, 1.e-6 * (1 + std::abs(exact)));
+    }
+  }
+}
+
+TEST(K_channels, charge_and_spin) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  int n_color = 10;
+  auto ch     = factorize_K(make_K(beta, n_color, 2001, 0.5), 1.e-10);
+  EXPECT_LT(ch.n_channels(), n_color);
+  EXPECT_LT(ch.max_error, 1.e-10);
+}
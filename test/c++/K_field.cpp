@@ -0,0 +1,64 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <random>
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs_ctseg/configuration.hpp>
+#include "./test_utils.hpp"
+
+using namespace triqs_ctseg;
+
+TEST(K_field, vs_K_overlap) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  std::mt19937_64 rng(42);
+  int n_color = 3;
+  long n_tau  = 10001;
+
+  auto K = gf<imtime>({beta, Boson, n_tau}, {n_color, n_color});
+  for (auto t : K.mesh())
+    for (int a = 0; a < n_color; ++a)
+      for (int b = 0; b < n_color; ++b)
+        K[t](a, b) = (1 + 0.1 * (a + b)) * std::sinh(0.3 * t.value()) * std::sinh(0.3 * (beta - t.value())) / 100;
+  auto K_table = interp_table_t{K};
+
+  std::vector<seglist_t> seglists;
+  for (int c = 0; c < n_color; ++c) seglists.push_back(random_seglist(rng, 15));
+
+  // Build the field incrementally, with some insertions and removals
+  auto field = K_field_t{n_color, n_tau};
+  for (auto const &[c, sl] : itertools::enumerate(seglists))
+    for (auto const &s : sl) field.add_segment(K_table, int(c), s.tau_c, s.tau_cdag, 1);
+  auto extra = random_seglist(rng, 2);
+  field.add_segment(K_table, 1, extra[0].tau_c, extra[0].tau_cdag, 1);
+  field.add_segment(K_table, 1, extra[0].tau_c, extra[0].tau_cdag, -1);
+
+  // Same as recomputed from scratch
+  auto field2 = K_field_t{n_color, n_tau};
+  field2.reset(K_table, seglists);
+  EXPECT_LT(field.max_difference(field2), 1.e-12);
+
+  // Same as the exact K_overlap, up to the interpolation error
+  for (int n = 0; n < 100; ++n) {
+    auto seg = random_seglist(rng, 1)[0];
+    for (int c1 = 0; c1 < n_color; ++c1) {
+      double exact = 0;
+      for (int c2 = 0; c2 < n_color; ++c2) exact += K_overlap(seglists[c2], seg.tau_c, seg.tau_cdag, K_table, c1, c2);
+      EXPECT_NEAR(field.overlap(c1, seg.tau_c, seg.tau_cdag), exact, 1.e-6 * (1 + std::abs(exact)));
+    }
+  }
+}
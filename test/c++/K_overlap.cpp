@@ -0,0 +1,60 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <random>
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs_ctseg/configuration.hpp>
+#include "./test_utils.hpp"
+
+using namespace triqs_ctseg;
+
+// Previous implementation of K_overlap, through the generic gf evaluator
+double K_overlap_gf(seglist_t const &seglist, tau_t const &tau_c, tau_t const &tau_cdag,
+                    gf<imtime, matrix_valued> const &K, int c1, int c2) {
+  auto Ks       = slice_target_to_scalar(K, c1, c2);
+  double result = 0;
+  for (auto const &s : seglist) {
+    result += real(Ks(double(tau_c - s.tau_c)) + Ks(double(tau_cdag - s.tau_cdag)) - Ks(double(tau_cdag - s.tau_c))
+                   - Ks(double(tau_c - s.tau_cdag)));
+  }
+  return result;
+}
+
+TEST(K_overlap, table_vs_gf) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  std::mt19937_64 rng(123);
+
+  for (int n_color : {2, 6, 10}) {
+    // Some smooth K_ab(tau), with K(0) = K(beta) = 0
+    auto K = gf<imtime>({beta, Boson, 10001}, {n_color, n_color});
+    for (auto t : K.mesh())
+      for (int a = 0; a < n_color; ++a)
+        for (int b = 0; b < n_color; ++b)
+          K[t](a, b) = (1 + 0.1 * (a + b)) * std::sinh(0.3 * t.value()) * std::sinh(0.3 * (beta - t.value()));
+    auto K_table = interp_table_t{K};
+
+    std::vector<seglist_t> seglists;
+    for (int c = 0; c < n_color; ++c) seglists.push_back(random_seglist(rng, 20));
+    auto seg = random_seglist(rng, 1)[0];
+
+    // Same values, up to rounding
+    for (int c = 0; c < n_color; ++c)
+      EXPECT_NEAR(K_overlap(seglists[c], seg.tau_c, seg.tau_cdag, K_table, 0, c),
+                  K_overlap_gf(seglists[c], seg.tau_c, seg.tau_cdag, K, 0, c), 1.e-10);
+  }
+}
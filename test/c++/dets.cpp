@@ -0,0 +1,303 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <algorithm>
+#include <random>
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs_ctseg/dets.hpp>
+#include <triqs_ctseg/util.hpp>
+
+using namespace triqs_ctseg;
+using op_t = std::pair<tau_t, int>;
+
+// The same random sequence of tries in a det with immediate and with delayed updates
+TEST(dets, delayed_updates) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+
+  auto Delta = gf<imtime, matrix_real_valued>{{beta, Fermion, 2001}, {2, 2}};
+  for (auto t : Delta.mesh()) {
+    double tau     = t.value();
+    Delta[t](0, 0) = -0.5 * (std::exp(-tau) + std::exp(-(beta - tau))) / (1 + std::exp(-beta));
+    Delta[t](1, 1) = -0.3 * std::cosh(0.5 * (tau - beta / 2)) / std::cosh(0.25 * beta);
+    Delta[t](0, 1) = 0.1 * std::sin(M_PI * tau / beta);
+    Delta[t](1, 0) = Delta[t](0, 1);
+  }
+
+  for (long n_delayed : {1, 3, 8}) {
+    auto D_ref = det_t{Delta_block_adaptor{Delta}, 100};
+    auto D     = det_t{Delta_block_adaptor{Delta}, 100, n_delayed};
+    std::mt19937_64 rng(n_delayed);
+    for (int n = 0; n < 2000; ++n) {
+      double r = 0, r_ref = 0;
+      if (D.size() < 2 or (D.size() < 20 and rng() % 2 == 0)) {
+        op_t x{tau_t{rng()}, int(rng() % 2)}, y{tau_t{rng()}, int(rng() % 2)};
+        long i = det_lower_bound_x(D, x.first), j = det_lower_bound_y(D, y.first);
+        r_ref  = D_ref.try_insert(i, j, x, y);
+        r      = D.try_insert(i, j, x, y);
+      } else {
+        long i = rng() % D.size(), j = rng() % D.size();
+        r_ref  = D_ref.try_remove(i, j);
+        r      = D.try_remove(i, j);
+      }
+      EXPECT_NEAR(r, r_ref, 1.e-6 * std::max(1.0, std::abs(r_ref)));
+      if (rng() % 3 == 0) {
+        D_ref.reject_last_try();
+        D.reject_last_try();
+      } else {
+        D_ref.complete_operation();
+        D.complete_operation();
+      }
+      // Same configuration, and same inverse once the pending updates are applied
+      ASSERT_EQ(D.size(), D_ref.size());
+      for (long k = 0; k < D.size(); ++k) {
+        EXPECT_EQ(D.get_x(k), D_ref.get_x(k));
+        EXPECT_EQ(D.get_y(k), D_ref.get_y(k));
+      }
+      if (n % 100 == 0)
+        for (long j = 0; j < D.size(); ++j)
+          for (long i = 0; i < D.size(); ++i) {
+            double ref = D_ref.inverse_matrix(j, i);
+            EXPECT_NEAR(D.inverse_matrix(j, i), ref, 1.e-6 * std::max(1.0, std::abs(ref)));
+          }
+    }
+  }
+}
+
+// A 2x2 block of Delta(tau)
+auto make_Delta(double beta) {
+  auto Delta = gf<imtime, matrix_real_valued>{{beta, Fermion, 2001}, {2, 2}};
+  for (auto t : Delta.mesh()) {
+    double tau     = t.value();
+    Delta[t](0, 0) = -0.5 * (std::exp(-tau) + std::exp(-(beta - tau))) / (1 + std::exp(-beta));
+    Delta[t](1, 1) = -0.3 * std::cosh(0.5 * (tau - beta / 2)) / std::cosh(0.25 * beta);
+    Delta[t](0, 1) = 0.1 * std::sin(M_PI * tau / beta);
+    Delta[t](1, 0) = Delta[t](0, 1);
+  }
+  return Delta;
+}
+
+// The same random sequence of tries in D and D_ref, with at most max_size operators
+void compare_dets(det_t &D, det_t &D_ref, uint64_t seed, long max_size) {
+  std::mt19937_64 rng(seed);
+  for (int n = 0; n < 2000; ++n) {
+    double r = 0, r_ref = 0;
+    if (D.size() < 2 or (D.size() < max_size and rng() % 2 == 0)) {
+      op_t x{tau_t{rng()}, int(rng() % 2)}, y{tau_t{rng()}, int(rng() % 2)};
+      long i = det_lower_bound_x(D, x.first), j = det_lower_bound_y(D, y.first);
+      r_ref  = D_ref.try_insert(i, j, x, y);
+      r      = D.try_insert(i, j, x, y);
+    } else {
+      long i = rng() % D.size(), j = rng() % D.size();
+      r_ref  = D_ref.try_remove(i, j);
+      r      = D.try_remove(i, j);
+    }
+    EXPECT_NEAR(r, r_ref, 1.e-6 * std::max(1.0, std::abs(r_ref)));
+    if (rng() % 3 == 0) {
+      D_ref.reject_last_try();
+      D.reject_last_try();
+    } else {
+      D_ref.complete_operation();
+      D.complete_operation();
+    }
+    // Same configuration, and same inverse (once the pending updates are applied, for a delayed det)
+    ASSERT_EQ(D.size(), D_ref.size());
+    for (long k = 0; k < D.size(); ++k) {
+      EXPECT_EQ(D.get_x(k), D_ref.get_x(k));
+      EXPECT_EQ(D.get_y(k), D_ref.get_y(k));
+    }
+    if (n % 100 == 0)
+      for (long j = 0; j < D.size(); ++j)
+        for (long i = 0; i < D.size(); ++i) {
+          double ref = D_ref.inverse_matrix(j, i);
+          EXPECT_NEAR(D.inverse_matrix(j, i), ref, 1.e-6 * std::max(1.0, std::abs(ref)));
+        }
+  }
+}
+
+TEST(dets, small_blocks) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  auto Delta = make_Delta(beta);
+
+  // Below and beyond the inline storage, always a small det
+  for (long max_size : {10, 40}) {
+    auto D_ref = det_t{Delta_block_adaptor{Delta}, 100};
+    auto D     = det_t{Delta_block_adaptor{Delta}, 100, 0, 1000};
+    compare_dets(D, D_ref, max_size, max_size);
+    EXPECT_TRUE(D.is_small());
+  }
+
+  // Switching between a small det (order <= 8) and a det_manip or a delayed det
+  for (long n_delayed : {0, 3}) {
+    auto D_ref = det_t{Delta_block_adaptor{Delta}, 100};
+    auto D     = det_t{Delta_block_adaptor{Delta}, 100, n_delayed, 8};
+    compare_dets(D, D_ref, 7, 20);
+    if (D.size() <= 4) EXPECT_TRUE(D.is_small());
+    if (D.size() > 8) EXPECT_FALSE(D.is_small());
+  }
+}
+
+TEST(dets, adaptive_check) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  auto Delta = make_Delta(beta);
+  for (auto [n_delayed, small_max_order] : {std::pair{0l, 0l}, std::pair{4l, 0l}, std::pair{0l, 1000l}}) {
+    auto D_ref = det_t{Delta_block_adaptor{Delta}, 100};
+    auto D     = det_t{Delta_block_adaptor{Delta}, 100, n_delayed, small_max_order};
+    D.enable_adaptive_check(10);
+    compare_dets(D, D_ref, 7, 20);
+    // The deviation stays far below the warning threshold: the interval only grows
+    EXPECT_GT(D.n_adaptive_checks(), 0);
+    EXPECT_LT(D.max_measured_drift(), 1.e-8);
+    EXPECT_GT(D.adaptive_check_interval(), 10);
+  }
+}
+
+TEST(dets, block_components) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  // A 4x4 block with the components {0, 2}, {1} and {3}
+  auto Delta = gf<imtime, matrix_real_valued>{{beta, Fermion, 2001}, {4, 4}};
+  Delta()    = 0;
+  for (auto t : Delta.mesh()) {
+    double tau = t.value();
+    for (int a : {0, 1, 2, 3}) Delta[t](a, a) = -0.5 * std::cosh((1 + 0.2 * a) * (tau - beta / 2)) / std::cosh(beta);
+    Delta[t](0, 2) = 0.1 * std::sin(M_PI * tau / beta);
+    Delta[t](2, 0) = Delta[t](0, 2);
+  }
+  auto components = Delta_block_components(Delta, 1.e-13);
+  ASSERT_EQ(components.size(), 3);
+  EXPECT_EQ(components[0], (std::vector<long>{0, 2}));
+  EXPECT_EQ(components[1], (std::vector<long>{1}));
+  EXPECT_EQ(components[2], (std::vector<long>{3}));
+
+  // Delta restricted to the component {0, 2}
+  auto Delta_02 = gf<imtime, matrix_real_valued>{Delta.mesh(), {2, 2}};
+  for (auto [k1, a1] : {std::pair{0, 0}, std::pair{1, 2}})
+    for (auto [k2, a2] : {std::pair{0, 0}, std::pair{1, 2}})
+      Delta_02.data()(range::all, k1, k2) = Delta.data()(range::all, a1, a2);
+
+  // The same operators of colors 0 and 2 in the full det (with an additional pair of color 1) and in the det of the
+  // component: the ratios are equal up to a sign
+  auto D_full = det_t{Delta_block_adaptor{Delta}, 100};
+  auto D_comp = det_t{Delta_block_adaptor{Delta_02}, 100};
+  std::mt19937_64 rng(5);
+  D_full.try_insert(0, 0, op_t{tau_t{rng()}, 1}, op_t{tau_t{rng()}, 1});
+  D_full.complete_operation();
+  for (int n = 0; n < 10; ++n) {
+    int k = int(rng() % 2);
+    op_t x{tau_t{rng()}, 2 * k}, y{tau_t{rng()}, 2 * k};
+    op_t x_comp{x.first, k}, y_comp{y.first, k};
+    double r_full = D_full.try_insert(det_lower_bound_x(D_full, x.first), det_lower_bound_y(D_full, y.first), x, y);
+    double r_comp = D_comp.try_insert(det_lower_bound_x(D_comp, x.first), det_lower_bound_y(D_comp, y.first), x_comp,
+                                      y_comp);
+    EXPECT_NEAR(std::abs(r_full), std::abs(r_comp), 1.e-10 * std::max(1.0, std::abs(r_full)));
+    D_full.complete_operation();
+    D_comp.complete_operation();
+  }
+}
+
+TEST(dets, change_col_row) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  auto Delta = make_Delta(beta);
+  for (auto [n_delayed, small_max_order] : {std::pair{0l, 0l}, std::pair{3l, 0l}, std::pair{0l, 1000l}}) {
+    auto D_ref = det_t{Delta_block_adaptor{Delta}, 100};
+    auto D     = det_t{Delta_block_adaptor{Delta}, 100, n_delayed, small_max_order};
+    std::mt19937_64 rng(11);
+    for (int n = 0; n < 500; ++n) {
+      double r = 0, r_ref = 0;
+      if (D.size() < 2 or (D.size() < 12 and rng() % 3 == 0)) {
+        op_t x{tau_t{rng()}, int(rng() % 2)}, y{tau_t{rng()}, int(rng() % 2)};
+        long i = det_lower_bound_x(D, x.first), j = det_lower_bound_y(D, y.first);
+        r_ref  = D_ref.try_insert(i, j, x, y);
+        r      = D.try_insert(i, j, x, y);
+      } else if (rng() % 5 == 0) {
+        // Some removals, so that the changes are also tried with pending removals in a delayed det
+        long i = rng() % D.size(), j = rng() % D.size();
+        r_ref  = D_ref.try_remove(i, j);
+        r      = D.try_remove(i, j);
+      } else {
+        // Change the index of a row and a column, at the same times, or of a single row or column
+        long i = rng() % D.size(), j = rng() % D.size();
+        int k  = int(rng() % 2);
+        op_t x{D.get_x(i).first, k}, y{D.get_y(j).first, k};
+        switch (rng() % 3) {
+          case 0:
+            r_ref = D_ref.try_change_col_row(i, j, x, y);
+            r     = D.try_change_col_row(i, j, x, y);
+            break;
+          case 1:
+            r_ref = D_ref.try_change_row(i, x);
+            r     = D.try_change_row(i, x);
+            break;
+          default:
+            r_ref = D_ref.try_change_col(j, y);
+            r     = D.try_change_col(j, y);
+        }
+      }
+      EXPECT_NEAR(r, r_ref, 1.e-8 * std::max(1.0, std::abs(r_ref)));
+      if (rng() % 4 == 0) {
+        D_ref.reject_last_try();
+        D.reject_last_try();
+      } else {
+        D_ref.complete_operation();
+        D.complete_operation();
+      }
+      ASSERT_EQ(D.size(), D_ref.size());
+      for (long k = 0; k < D.size(); ++k) {
+        EXPECT_EQ(D.get_x(k), D_ref.get_x(k));
+        EXPECT_EQ(D.get_y(k), D_ref.get_y(k));
+      }
+    }
+    // Element by element, and as a matrix
+    auto M_inv = D.inverse_matrix();
+    for (long j = 0; j < D.size(); ++j)
+      for (long i = 0; i < D.size(); ++i) {
+        double ref = D_ref.inverse_matrix(j, i);
+        EXPECT_NEAR(D.inverse_matrix(j, i), ref, 1.e-8 * std::max(1.0, std::abs(ref)));
+        EXPECT_NEAR(M_inv(j, i), ref, 1.e-8 * std::max(1.0, std::abs(ref)));
+      }
+  }
+}
+
+TEST(dets, refill) {
+  double beta = 20;
+  tau_t::set_beta(beta);
+  auto Delta = make_Delta(beta);
+  for (auto [n_delayed, small_max_order] : {std::pair{3l, 0l}, std::pair{0l, 1000l}}) {
+    auto D_ref = det_t{Delta_block_adaptor{Delta}, 100};
+    auto D     = det_t{Delta_block_adaptor{Delta}, 100, n_delayed, small_max_order};
+    compare_dets(D, D_ref, 5, 10);
+    // Refill with new operators (more than the inline storage of a small det), then go on with the same tries
+    std::mt19937_64 rng(13);
+    std::vector<op_t> x, y;
+    for (int n = 0; n < 40; ++n) {
+      x.emplace_back(tau_t{rng()}, int(rng() % 2));
+      y.emplace_back(tau_t{rng()}, int(rng() % 2));
+    }
+    auto by_time = [](op_t const &a, op_t const &b) { return a.first < b.first; };
+    std::sort(x.begin(), x.end(), by_time);
+    std::sort(y.begin(), y.end(), by_time);
+    double r_ref = D_ref.try_refill(x, y);
+    EXPECT_NEAR(D.try_refill(x, y), r_ref, 1.e-6 * std::max(1.0, std::abs(r_ref)));
+    D_ref.complete_operation();
+    D.complete_operation();
+    compare_dets(D, D_ref, 7, 50);
+  }
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+// The heat-bath choice of the color samples the same distribution: it reproduces the reference results of
+// anderson.cpp and spin_spin.cpp, up to the Monte Carlo noise.
+
+#include "./test_utils.hpp"
+
+using namespace triqs_ctseg;
+
+TEST(CTSEG, Anderson_heat_bath_color) {
+  mpi::communicator c;
+  auto results = run_anderson([](solve_params_t &p) {
+    p.heat_bath_color = true;
+    p.n_cycles        = 40000;
+  });
+  if (c.rank() == 0) expect_near_reference(results, "anderson.ref.h5");
+}
+
+TEST(CTSEG, Spin_Spin_heat_bath_color) {
+  mpi::communicator c;
+  auto results = run_spin_spin([](solve_params_t &p) {
+    p.heat_bath_color = true;
+    p.n_cycles        = 40000;
+  });
+  if (c.rank() == 0) expect_near_reference(results, "spin_spin.ref.h5");
+}
+MAKE_MAIN;
@@ -0,0 +1,105 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+// Consistency of the measures of the same quantity on the run of anderson.cpp: the measures do not change the
+// random walk, so the configurations are those of the reference anderson.ref.h5.
+
+#include "./test_utils.hpp"
+#include <triqs/utility/legendre.hpp>
+
+using namespace triqs_ctseg;
+
+// Fourier transform of g(tau) at the frequency i nu, by the trapezoidal rule on the tau mesh
+dcomplex fourier_trapezoid(gf_const_view<imtime> g, double beta, double nu) {
+  auto d       = g.data();
+  long n       = d.extent(0);
+  double dtau  = beta / double(n - 1);
+  dcomplex res = 0;
+  for (long i = 0; i < n; ++i) {
+    double w = (i == 0 or i == n - 1) ? 0.5 : 1.0;
+    res += w * std::exp(dcomplex(0, nu * dtau * double(i))) * d(i, 0, 0);
+  }
+  return res * dtau;
+}
+
+// G(tau) = sum_l sqrt(2l + 1) / beta P_l(2 tau / beta - 1) G_l, on the tau mesh of g
+void set_from_legendre(gf_view<imtime> g, gf_const_view<legendre> gl, double beta) {
+  triqs::utility::legendre_generator P;
+  long n_l = gl.data().extent(0);
+  for (auto t : g.mesh()) {
+    P.reset(2 * t.value() / beta - 1);
+    g[t] = 0;
+    for (long l = 0; l < n_l; ++l)
+      g[t] += std::sqrt(2 * l + 1) / beta * P.next() * gl.data()(l, range::all, range::all);
+  }
+}
+
+TEST(CTSEG, Anderson_measure_consistency) {
+  mpi::communicator c;
+  double beta  = 20.0;
+  auto results = run_anderson([](solve_params_t &p) {
+    p.nn_tau_average = true;
+    p.measure_nn_iw  = true;
+    p.n_iw_chi2      = 10;
+    p.measure_G_l    = true;
+    p.n_legendre_G   = 80;
+    p.measure_G_iw   = true;
+    p.n_iw_G         = 20;
+  });
+  if (c.rank() != 0) return;
+
+  h5::file ref_file("anderson.ref.h5", 'r');
+  block_gf<imtime> G_tau;
+  block2_gf<imtime> nn_tau;
+  h5_read(ref_file, "G_tau", G_tau);
+  h5_read(ref_file, "nn_tau", nn_tau);
+
+  // Same configurations as the reference
+  EXPECT_BLOCK_GF_NEAR(G_tau, results.G_tau, 1.e-13);
+
+  auto const &nn_tau_av = results.nn_tau.value();
+  auto const &nn_iw     = results.nn_iw.value();
+  for (auto b1 : range(2))
+    for (auto b2 : range(2)) {
+      // The averaged nn_tau agrees with the plain one, up to the noise of the latter
+      expect_coarse_grained_near(nn_tau(b1, b2), nn_tau_av(b1, b2), 0.03);
+
+      // nn_iw is the Fourier transform of nn_tau: the averaged estimator of nn_tau is exact on the mesh, so that they
+      // agree up to the error of the trapezoidal rule
+      for (auto w : nn_iw(b1, b2).mesh()) {
+        if (w.index() < 0) continue;
+        double nu = 2 * M_PI * double(w.index()) / beta;
+        EXPECT_COMPLEX_NEAR(nn_iw(b1, b2)[w](0, 0), fourier_trapezoid(nn_tau_av(b1, b2), beta, nu), 1.e-4);
+      }
+    }
+
+  // G_tau from the Legendre coefficients agrees with the measured G_tau (same configurations, other binning)
+  for (auto bl : range(2)) {
+    auto G_tau_l = gf<imtime>{G_tau[bl].mesh(), {1, 1}};
+    set_from_legendre(G_tau_l, results.G_l.value()[bl], beta);
+    expect_coarse_grained_near(G_tau[bl], G_tau_l, 0.01);
+  }
+
+  // G_iw is the Fourier transform of the measured G_tau (same configurations), up to the error of the trapezoidal
+  // rule on the binned G_tau
+  for (auto bl : range(2))
+    for (auto w : results.G_iw.value()[bl].mesh()) {
+      double omega = M_PI * double(2 * w.index() + 1) / beta;
+      EXPECT_COMPLEX_NEAR(results.G_iw.value()[bl][w](0, 0), fourier_trapezoid(G_tau[bl], beta, omega), 1.e-3);
+    }
+}
+MAKE_MAIN;
@@ -0,0 +1,44 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <random>
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs_ctseg/configuration.hpp>
+
+using namespace triqs_ctseg;
+
+// The same random sequence of insertions and erasures in a chunked_list and a std::vector
+TEST(seglist, chunked_list) {
+  std::mt19937_64 rng(5);
+  std::vector<long> v;
+  chunked_list<long, 4> c; // small chunks, to split and merge often
+  for (int op = 0; op < 5000; ++op) {
+    if (v.empty() or rng() % 3 != 0) {
+      long x = rng() % 1000, p = rng() % (v.size() + 1);
+      v.insert(v.begin() + p, x);
+      auto it = c.insert(c.begin() + p, x);
+      EXPECT_EQ(it - c.begin(), p);
+    } else {
+      long p = rng() % v.size();
+      v.erase(v.begin() + p);
+      c.erase(c.cbegin() + p);
+    }
+    ASSERT_EQ(c.size(), long(v.size()));
+    for (long i = 0; i < c.size(); ++i) EXPECT_EQ(c[i], v[i]);
+    EXPECT_TRUE(std::equal(c.begin(), c.end(), v.begin()));
+  }
+}
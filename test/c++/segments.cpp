@@ -87,5 +87,58 @@ TEST(segment, is_insertable) {
   EXPECT_TRUE(is_insertable_into(S(0.5, 5), v));
 }
 
+// ------------------------------
+
+TEST(segment, occupancy_index) {
+  tau_t::set_beta(beta);
+
+  // Non-cyclic, cyclic and full line lists
+  for (auto const &v :
+       {seglist_t{S(9, 7), S(5, 4.5), S(2, 1)}, seglist_t{S(8, 6), S(3, 2), S(0.5, 9.5)}, seglist_t{S(beta, 0)}}) {
+    auto config        = configuration_t{1};
+    config.seglists[0] = v;
+    config.update_occupancy(0);
+
+    double total = 0;
+    for (auto const &s : v) total += double(s.length());
+    EXPECT_NEAR(double(config.occupancy[0].total()), total, precision);
+
+    for (auto const &seg : {S(8.5, 4.7), S(6, 5.5), S(4.7, 0.2), S(1.5, 9), S(0.7, 8.5), S(beta, 0)})
+      EXPECT_NEAR(overlap(config, 0, seg), overlap(v, seg), precision);
+  }
+}
+
+// ------------------------------
+
+TEST(segment, flipped_view) {
+  tau_t::set_beta(beta);
+
+  for (auto const &v : {seglist_t{S(9, 7), S(5, 4.5), S(2, 1)}, seglist_t{S(8, 6), S(3, 2), S(0.5, 9.5)},
+                        seglist_t{S(beta, 0)}, seglist_t{}, seglist_t{S(3, 2)}}) {
+    auto vf   = flip(v);
+    auto view = flipped_view_t{v};
+    ASSERT_EQ(view.size(), long(vf.size()));
+    for (long i = 0; i < view.size(); ++i) EXPECT_EQ(view[i], vf[i]);
+
+    // Removing an antisegment = removing the segment in the flipped list
+    for (long i = 0; i < view.size(); ++i) {
+      auto w = v, wf = vf;
+      fill_antisegment(w, i);
+      wf.erase(wf.begin() + i);
+      EXPECT_EQ(w, flip(wf));
+    }
+
+    // Inserting an antisegment = inserting the segment in the flipped list
+    for (auto const &seg : {S(8.5, 7.5), S(4.9, 4.6), S(1.5, 1.2), S(0.2, 9.8), S(6, 5.5), S(beta, 0)}) {
+      EXPECT_EQ(is_inside(seg, v), is_insertable_into(seg, vf));
+      if (not is_inside(seg, v)) continue;
+      auto w = v, wf = vf;
+      cut_antisegment(w, seg);
+      wf.insert(std::upper_bound(wf.begin(), wf.end(), seg), seg);
+      EXPECT_EQ(w, flip(wf));
+    }
+  }
+}
+
 // TEST OVERLAP
 //
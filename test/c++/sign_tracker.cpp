@@ -0,0 +1,85 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <random>
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs_ctseg/work_data.hpp>
+
+using namespace triqs_ctseg;
+using triqs::operators::n;
+using op_t = std::pair<tau_t, int>;
+
+// A random sequence of insertions and removals of (cdag, c) pairs of the same color in the det of a block of 3
+// colors, coupled by Delta. After each update, the tracked sign is the sign trace_sign recomputes from the det.
+TEST(sign_tracker, vs_trace_sign) {
+  double beta  = 10;
+  int n_colors = 3;
+
+  constr_params_t cp;
+  cp.beta      = beta;
+  cp.gf_struct = {{"bl", n_colors}};
+  solve_params_t sp;
+  sp.h_int    = n("bl", 0) * n("bl", 1) + n("bl", 1) * n("bl", 2);
+  sp.h_loc0   = -0.5 * (n("bl", 0) + n("bl", 1) + n("bl", 2));
+  sp.n_cycles = 1;
+  auto p      = params_t{cp, sp};
+  tau_t::set_beta(beta);
+
+  inputs_t inputs;
+  inputs.Delta    = block_gf<imtime>({beta, Fermion, cp.n_tau}, cp.gf_struct);
+  inputs.D0t      = make_block2_gf<imtime>({beta, Boson, cp.n_tau_bosonic}, cp.gf_struct);
+  inputs.Jperpt   = gf<imtime>({beta, Boson, cp.n_tau_bosonic}, {1, 1});
+  inputs.D0t()    = 0;
+  inputs.Jperpt() = 0;
+  for (auto t : inputs.Delta[0].mesh()) {
+    double tau = t.value();
+    for (int a = 0; a < n_colors; ++a)
+      for (int b = 0; b < n_colors; ++b)
+        inputs.Delta[0][t](a, b) = (a == b) ? -0.5 * (std::exp(-(1 + 0.2 * a) * tau) + std::exp(-(beta - tau)))
+                                            : 0.1 * (1 + a + b) * std::sin(M_PI * tau / beta);
+  }
+
+  auto wdata = work_data_t{p, inputs, mpi::communicator{}};
+  ASSERT_EQ(long(wdata.dets.size()), 1);
+  ASSERT_EQ(long(wdata.det_colors[0].size()), n_colors);
+  auto &D = wdata.dets[0];
+
+  std::mt19937_64 rng(13);
+  std::vector<std::pair<op_t, op_t>> pairs; // The (cdag, c) pairs in the det
+  for (int n = 0; n < 2000; ++n) {
+    double old_sign = trace_sign(wdata);
+    double ratio    = 0;
+    if (pairs.empty() or (pairs.size() < 20 and rng() % 2 == 0)) {
+      int color = int(rng() % n_colors);
+      op_t x{tau_t{rng()}, color}, y{tau_t{rng()}, color};
+      D.try_insert(det_lower_bound_x(D, x.first), det_lower_bound_y(D, y.first), x, y);
+      D.complete_operation();
+      ratio = wdata.record_insert(0, x, y);
+      pairs.emplace_back(x, y);
+    } else {
+      long k      = long(rng() % pairs.size());
+      auto [x, y] = pairs[k];
+      D.try_remove(det_lower_bound_x(D, x.first), det_lower_bound_y(D, y.first));
+      D.complete_operation();
+      ratio = wdata.record_remove(0, x, y);
+      pairs.erase(pairs.begin() + k);
+    }
+    double new_sign = trace_sign(wdata);
+    EXPECT_EQ(wdata.tracked_trace_sign(), new_sign);
+    EXPECT_EQ(ratio, new_sign / old_sign);
+  }
+}
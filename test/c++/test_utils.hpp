@@ -0,0 +1,169 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+// Helpers shared by the tests
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs_ctseg/configuration.hpp>
+#include <triqs_ctseg/solver_core.hpp>
+
+namespace triqs_ctseg {
+
+  // A random list of n non-overlapping segments, in decreasing order
+  inline seglist_t random_seglist(auto &rng, int n) {
+    std::vector<uint64_t> times(2 * n);
+    for (auto &t : times) t = rng();
+    std::sort(times.begin(), times.end(), std::greater<>{});
+    seglist_t sl;
+    for (int i = 0; i < n; ++i) sl.push_back(segment_t{tau_t{times[2 * i]}, tau_t{times[2 * i + 1]}});
+    return sl;
+  }
+
+  // The Anderson impurity of anderson.cpp (reference anderson.ref.h5), solved with the solve parameters of the test
+  // modified by set_params
+  inline results_t run_anderson(std::function<void(solve_params_t &)> const &set_params) {
+    using triqs::operators::n;
+    double beta    = 20.0;
+    double U       = 1.0;
+    double mu      = 0.5;
+    double epsilon = 0.2;
+    int n_iw       = 1000;
+
+    constr_params_t param_constructor;
+    param_constructor.beta      = beta;
+    param_constructor.gf_struct = {{"up", 1}, {"down", 1}};
+    param_constructor.n_tau     = 10001;
+    solver_core Solver(param_constructor);
+
+    solve_params_t param_solve;
+    param_solve.h_int             = U * n("up", 0) * n("down", 0);
+    param_solve.h_loc0            = -mu * (n("up", 0) + n("down", 0));
+    param_solve.n_cycles          = 10000;
+    param_solve.n_warmup_cycles   = 1000;
+    param_solve.length_cycle      = 50;
+    param_solve.random_seed       = 23488;
+    param_solve.measure_F_tau     = true;
+    param_solve.measure_nn_tau    = true;
+    param_solve.measure_nn_static = true;
+    set_params(param_solve);
+
+    nda::clef::placeholder<0> om_;
+    auto Delta_w   = gf<imfreq>({beta, Fermion, n_iw}, {1, 1});
+    auto Delta_tau = gf<imtime>({beta, Fermion, param_constructor.n_tau}, {1, 1});
+    Delta_w(om_) << 1.0 / (om_ - epsilon);
+    Delta_tau()           = fourier(Delta_w);
+    Solver.Delta_tau()[0] = Delta_tau;
+    Solver.Delta_tau()[1] = Delta_tau;
+
+    Solver.solve(param_solve);
+    return Solver.results;
+  }
+
+  // The spin-spin model of spin_spin.cpp (reference spin_spin.ref.h5), solved with the solve parameters of the test
+  // modified by set_params
+  inline results_t run_spin_spin(std::function<void(solve_params_t &)> const &set_params) {
+    using triqs::operators::n;
+    double beta    = 10.0;
+    double U       = 4.0;
+    double mu      = 2.0;
+    double epsilon = 0.3;
+    int n_iw       = 5000;
+
+    constr_params_t param_constructor;
+    param_constructor.beta          = beta;
+    param_constructor.gf_struct     = {{"up", 1}, {"down", 1}};
+    param_constructor.n_tau         = 10001;
+    param_constructor.n_tau_bosonic = 10001;
+    solver_core Solver(param_constructor);
+
+    solve_params_t param_solve;
+    param_solve.h_int             = U * n("up", 0) * n("down", 0);
+    param_solve.h_loc0            = -mu * (n("up", 0) + n("down", 0));
+    param_solve.n_cycles          = 10000;
+    param_solve.n_warmup_cycles   = 1000;
+    param_solve.length_cycle      = 50;
+    param_solve.random_seed       = 23488;
+    param_solve.measure_F_tau     = true;
+    param_solve.measure_nn_tau    = true;
+    param_solve.measure_nn_static = true;
+    set_params(param_solve);
+
+    nda::clef::placeholder<0> om_;
+    auto Delta_w   = gf<imfreq>({beta, Fermion, n_iw}, {1, 1});
+    auto Delta_tau = gf<imtime>({beta, Fermion, param_constructor.n_tau}, {1, 1});
+    Delta_w(om_) << 1.0 / (om_ - epsilon) + 1.0 / (om_ + epsilon);
+    Delta_tau()           = fourier(Delta_w);
+    Solver.Delta_tau()[0] = Delta_tau;
+    Solver.Delta_tau()[1] = Delta_tau;
+
+    double l  = 1.0; // electron boson coupling
+    double w0 = 1.0; // screening frequency
+    auto J0w  = gf<imfreq>({beta, Boson, n_iw}, {1, 1});
+    auto D0w  = gf<imfreq>({beta, Boson, n_iw}, {1, 1});
+    auto D0t  = gf<imtime>({beta, Boson, param_constructor.n_tau}, {1, 1});
+    J0w(om_) << 4 * l * l * w0 / (om_ * om_ - w0 * w0);
+    D0w(om_) << l * l * w0 / (om_ * om_ - w0 * w0);
+    D0t()                 = fourier(D0w);
+    Solver.D0_tau()(0, 0) = D0t;
+    Solver.D0_tau()(0, 1) = -D0t;
+    Solver.D0_tau()(1, 0) = -D0t;
+    Solver.D0_tau()(1, 1) = D0t;
+    Solver.Jperp_tau()    = fourier(J0w);
+
+    Solver.solve(param_solve);
+    return Solver.results;
+  }
+
+  // Averages of the real part of g(tau)(0, 0) over n_bins intervals of the tau mesh. Two runs with different random
+  // numbers agree on these up to a small Monte Carlo noise, unlike on each point of a fine mesh
+  inline std::vector<double> coarse_grained(gf_const_view<imtime> g, long n_bins) {
+    auto d = g.data();
+    long n = d.extent(0);
+    std::vector<double> sum(n_bins, 0.0), count(n_bins, 0.0);
+    for (long i = 0; i < n; ++i) {
+      sum[i * n_bins / n] += std::real(d(i, 0, 0));
+      count[i * n_bins / n] += 1;
+    }
+    for (long b = 0; b < n_bins; ++b) sum[b] /= count[b];
+    return sum;
+  }
+
+  // Check that the coarse-grained g1 and g2 agree within tolerance
+  inline void expect_coarse_grained_near(gf_const_view<imtime> g1, gf_const_view<imtime> g2, double tolerance,
+                                         long n_bins = 20) {
+    auto c1 = coarse_grained(g1, n_bins), c2 = coarse_grained(g2, n_bins);
+    for (long b = 0; b < n_bins; ++b) EXPECT_NEAR(c1[b], c2[b], tolerance) << "bin " << b;
+  }
+
+  // Check the densities and the coarse-grained G_tau of a run against a reference file, up to the Monte Carlo noise
+  inline void expect_near_reference(results_t const &results, std::string const &ref_name) {
+    h5::file ref_file(ref_name, 'r');
+    block_gf<imtime> G_tau;
+    std::map<std::string, nda::array<double, 1>> densities;
+    h5_read(ref_file, "G_tau", G_tau);
+    h5_read(ref_file, "densities", densities);
+    for (auto const &bl : {"up", "down"}) EXPECT_NEAR(densities[bl](0), results.densities.value().at(bl)(0), 0.01);
+    for (auto bl : range(2)) expect_coarse_grained_near(G_tau[bl], results.G_tau[bl], 0.02);
+  }
+
+} // namespace triqs_ctseg
@@ -0,0 +1,49 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <random>
+#include <set>
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs_ctseg/time_set.hpp>
+
+using namespace triqs_ctseg;
+
+// The same random sequence of insertions, erasures and lookups in a time_set_t and a std::set
+TEST(time_set, vs_std_set) {
+  std::mt19937_64 rng(7);
+  time_set_t ts;
+  std::set<tau_t> s;
+  std::vector<tau_t> pool(500);
+  for (auto &t : pool) t = tau_t{rng()};
+  pool[0] = tau_t::zero();
+  pool[1] = tau_t::beta();
+  for (int n = 0; n < 20000; ++n) {
+    auto tau = pool[rng() % pool.size()];
+    if (n < 10000 ? rng() % 3 != 0 : rng() % 3 == 0) {
+      ts.insert(tau);
+      s.insert(tau);
+    } else {
+      ts.erase(tau);
+      s.erase(tau);
+    }
+    EXPECT_EQ(ts.size(), long(s.size()));
+    for (int k = 0; k < 10; ++k) {
+      auto t = pool[rng() % pool.size()];
+      EXPECT_EQ(ts.contains(t), s.count(t) == 1);
+    }
+  }
+}
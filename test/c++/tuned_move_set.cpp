@@ -0,0 +1,84 @@
+// Copyright (c) 2022-2024 Simons Foundation
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You may obtain a copy of the License at
+//     https://www.gnu.org/licenses/gpl-3.0.txt
+//
+// Authors: Nikita Kavokine, Olivier Parcollet, Nils Wentzell
+
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs_ctseg/moves/tuned_move_set.hpp>
+
+using namespace triqs_ctseg::moves;
+
+// A move accepted with probability p_accept (as if the Monte Carlo accepted any ratio r > u in [0, 1)), whose attempt
+// takes cost seconds on the fake clock now
+struct fake_move {
+  double &now;
+  double p_accept;
+  double cost = 1.e-6;
+  double attempt() {
+    now += cost;
+    return p_accept;
+  }
+  double accept() { return 1; }
+  void reject() {}
+};
+
+// Run the moves as mc_generic would
+void run(tuned_move_set &set, triqs::mc_tools::random_generator &rng, long n) {
+  for (long i = 0; i < n; ++i) {
+    if (rng() < set.attempt())
+      set.accept();
+    else
+      set.reject();
+  }
+}
+
+TEST(tuned_move_set, weights) {
+  triqs::mc_tools::random_generator rng("", 1);
+  double now = 0;
+  auto set   = tuned_move_set{rng, 20000};
+  set.set_clock([&now]() { return now; });
+  set.add(fake_move{now, 0.5}, "insert", 1, "insert");
+  set.add(fake_move{now, 0.5}, "remove", 1, "insert");
+  set.add(fake_move{now, 0.0}, "move", 1, "move");
+  set.add(fake_move{now, 0.5, 4.e-6}, "spin swap", 1, "spin swap");
+
+  // Before the tuning, the moves are proposed with equal weights
+  run(set, rng, 20000);
+  for (auto const &[name, w] : set.weights()) EXPECT_EQ(w, 1);
+  for (auto const &[name, s] : set.statistics()) {
+    EXPECT_NEAR(double(s.second.n_proposed) / 20000, 0.25, 0.02);
+    EXPECT_EQ(s.first.n_proposed, s.second.n_proposed);
+  }
+
+  // After the tuning: a never accepted move has the minimal weight, a move and its inverse have the same weight,
+  // and a slower move has a smaller weight
+  run(set, rng, 20000);
+  auto w = set.weights();
+  EXPECT_EQ(w["insert"], 1);
+  EXPECT_EQ(w["remove"], 1);
+  EXPECT_EQ(w["move"], tuned_move_set::min_weight);
+  EXPECT_NEAR(w["spin swap"], 0.25, 0.03); // Same acceptance rate, 4 times slower
+  auto stats = set.statistics();
+  double total = 0;
+  for (auto const &[name, wn] : w) total += wn;
+  EXPECT_NEAR(double(stats["move"].first.n_proposed - stats["move"].second.n_proposed) / 20000,
+              tuned_move_set::min_weight / total, 0.01);
+
+  // The acceptance statistics of each move are kept over the whole run
+  EXPECT_EQ(stats["move"].first.n_accepted, 0);
+  for (auto const &name : {"insert", "remove", "spin swap"})
+    EXPECT_NEAR(double(stats[name].first.n_accepted) / stats[name].first.n_proposed, 0.5, 0.03);
+  EXPECT_NEAR(stats["spin swap"].second.time, 4.e-6 * stats["spin swap"].second.n_proposed, 1.e-9);
+}